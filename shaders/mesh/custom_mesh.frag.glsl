@@ -31,8 +31,9 @@ layout(location=0) out vec4 FragColor;
 uniform sampler2D image_texture;   // Texture image identifiant
 
 uniform sampler2DArray causticMapArray;
-uniform int caustic_frame_count;
-uniform float  caustic_fps;
+uniform int caustic_layer;   // frame to show, picked on the CPU (streamed ring of frames)
+uniform int caustic_next_layer;
+uniform float caustic_blend; // weight of the next frame, 0: no second fetch
 uniform float caustic_scale;
 uniform float caustic_intensity;
 
@@ -136,13 +137,14 @@ void main()
 	vec3 color_shading = (Ka + Kd * diffuse_component) * color_object + Ks * specular_component * vec3(1.0, 1.0, 1.0);
 
     // —— caustics flip‐book ——
-    float f = time * caustic_fps;
-    int   idx = int(mod(f, float(caustic_frame_count)));
+    int   idx = caustic_layer;
 
     vec2 caUV = fragment.position.xz * caustic_scale
                 + vec2(time * 0.5);
-    float ca = texture(causticMapArray, vec3(fract(caUV), idx)).r
-            * caustic_intensity;
+    float ca = texture(causticMapArray, vec3(caUV, idx)).r;  // GL_REPEAT: no fract(), it breaks the mip selection
+    if (caustic_blend > 0.0)
+        ca = mix(ca, texture(causticMapArray, vec3(caUV, caustic_next_layer)).r, caustic_blend);
+    ca *= caustic_intensity;
     color_shading += ca * color_object;
 
 	// Add Fog
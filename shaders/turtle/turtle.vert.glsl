@@ -1,19 +1,56 @@
 #version 330 core
 /* ────────────── vertex attributes coming from the VAO ────────────── */
-layout(location = 0) in vec3  vertex_position;   // POSITION
-layout(location = 1) in vec3  vertex_normal;     // NORMAL
-layout(location = 2) in vec3  vertex_color;      // COLOR_0   (optional)
-layout(location = 3) in vec2  vertex_uv;         // TEXCOORD_0
-layout(location = 4) in uvec4 vertex_joint;      // JOINTS_0  (added)
-layout(location = 5) in vec4  vertex_weight;     // WEIGHTS_0 (added)
+/*  packed_skin_vertex (see src/loader/packed_vertex.hpp)               */
+layout(location = 0) in vec3  vertex_position;   // POSITION   unorm16, in [0,1]^3
+layout(location = 1) in vec2  vertex_normal;     // NORMAL     octahedral, snorm16
+layout(location = 3) in vec2  vertex_uv;         // TEXCOORD_0 half float
+layout(location = 4) in uvec4 vertex_joint;      // JOINTS_0   uint8
+layout(location = 5) in vec4  vertex_weight;     // WEIGHTS_0  unorm16
 
 /* ────────────── standard CGP uniforms ─────────────────────────────── */
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
-/* ────────────── skinning matrices (filled from C++) ───────────────── */
-uniform mat4 uBones[64];
+/* ────────────── position dequantization (bounding box) ────────────── */
+uniform vec3 uPositionOffset;
+uniform vec3 uPositionScale;
+
+/* ────────────── skinning transforms (bone_palette, filled from C++) ── */
+/*  layout chosen per actor: SKINNING_AFFINE / SKINNING_DUAL_QUATERNION  */
+/*  inserted after #version (see skinning_defines), 4x4 matrices if none */
+uniform samplerBuffer uBonePalette;   // every actor of the frame
+uniform int           uBoneOffset;    // first texel of this actor
+uniform int           uInstanceTable; // >= 0: instanced draw, model and uBoneOffset of each
+                                      // instance from its record there (5 texels)
+
+/* ────────────── baked cycle (baked_animation): uBakedFrames poses of ─ */
+/*  one period, uBakedStride texels each, in the layout of this variant  */
+uniform samplerBuffer uBakedAnimation;
+uniform int           uBakedFrames;   // 0: no baked cycle bound
+uniform int           uBakedStride;
+uniform float         uBakedTime;     // draw time, in periods
+
+#if defined(SKINNING_DUAL_QUATERNION)
+const int bone_texels = 2;            // rotation, dual part
+#elif defined(SKINNING_AFFINE)
+const int bone_texels = 3;            // rows of the 3x4 matrix
+#else
+const int bone_texels = 4;            // columns of the 4x4 matrix
+#endif
+
+int   bone_base;                      // uBoneOffset, or that of the instance
+int   baked_next;                     // baked instance: bone_base (in uBakedAnimation) and
+float baked_blend = -1.0;             // the next frame, blended by baked_blend (< 0: palette)
+
+vec4 bone_texel(uint j, int k)
+{
+    int o = bone_texels * int(j) + k;
+    if (baked_blend >= 0.0)
+        return mix(texelFetch(uBakedAnimation, bone_base + o), texelFetch(uBakedAnimation, baked_next + o),
+                   baked_blend);
+    return texelFetch(uBonePalette, bone_base + o);
+}
 
 /* ────────────── data sent to the fragment shader ──────────────────── */
 out struct fragment_data
@@ -25,25 +62,84 @@ out struct fragment_data
 } fragment;
 
 /* -------------------------------------------------------------------- */
+vec3 octahedral_decode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
 void main()
 {
-    /* --------- linear-blend skinning --------------------------------- */
-    mat4 skin =
-          vertex_weight.x * uBones[int(vertex_joint.x)] +
-          vertex_weight.y * uBones[int(vertex_joint.y)] +
-          vertex_weight.z * uBones[int(vertex_joint.z)] +
-          vertex_weight.w * uBones[int(vertex_joint.w)];
+    vec3 position = uPositionOffset + uPositionScale * vertex_position;
+    vec3 normal   = octahedral_decode(max(vertex_normal, vec2(-1.0)));
 
-    vec4 Pskinned = skin * vec4(vertex_position, 1.0);
-    vec3 Nskinned = mat3(skin) * vertex_normal;
+    mat4 M    = model;
+    bone_base = uBoneOffset;
+    if (uInstanceTable >= 0) {
+        int t = uInstanceTable + 5 * gl_InstanceID;
+        M = mat4(texelFetch(uBonePalette, t),     texelFetch(uBonePalette, t + 1),
+                 texelFetch(uBonePalette, t + 2), texelFetch(uBonePalette, t + 3));
+        vec4 record = texelFetch(uBonePalette, t + 4);   // bone offset, baked phase
+        bone_base = int(record.x);
+        if (record.y >= 0.0 && uBakedFrames > 0) {
+            float f     = fract(uBakedTime + record.y) * float(uBakedFrames);
+            int   frame = min(int(f), uBakedFrames - 1);
+            bone_base   = uBakedStride * frame;
+            baked_next  = uBakedStride * ((frame + 1) % uBakedFrames);
+            baked_blend = fract(f);
+        }
+    }
+
+#if defined(SKINNING_DUAL_QUATERNION)
+    /* --------- dual-quaternion blending (rigid, keeps the volume) ---- */
+    vec4 pivot = bone_texel(vertex_joint.x, 0);
+    vec4 real  = vec4(0.0);
+    vec4 dual  = vec4(0.0);
+    for (int k = 0; k < 4; ++k) {
+        vec4  r = bone_texel(vertex_joint[k], 0);
+        float w = dot(r, pivot) < 0.0 ? -vertex_weight[k] : vertex_weight[k];   // same hemisphere
+        real += w * r;
+        dual += w * bone_texel(vertex_joint[k], 1);
+    }
+    float len = length(real);
+    real /= len;
+    dual /= len;
+    vec3 Pskinned = position + 2.0 * cross(real.xyz, cross(real.xyz, position) + real.w * position)
+                  + 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+    vec3 Nskinned = normal + 2.0 * cross(real.xyz, cross(real.xyz, normal) + real.w * normal);
+#elif defined(SKINNING_AFFINE)
+    /* --------- linear-blend skinning, 3x4 rows ----------------------- */
+    vec4 row[3];
+    for (int i = 0; i < 3; ++i)
+        row[i] = vertex_weight.x * bone_texel(vertex_joint.x, i) +
+                 vertex_weight.y * bone_texel(vertex_joint.y, i) +
+                 vertex_weight.z * bone_texel(vertex_joint.z, i) +
+                 vertex_weight.w * bone_texel(vertex_joint.w, i);
+    vec4 P = vec4(position, 1.0);
+    vec3 Pskinned = vec3(dot(row[0], P), dot(row[1], P), dot(row[2], P));
+    vec3 Nskinned = vec3(dot(row[0].xyz, normal), dot(row[1].xyz, normal), dot(row[2].xyz, normal));
+#else
+    /* --------- linear-blend skinning --------------------------------- */
+    mat4 skin = mat4(0.0);
+    for (int i = 0; i < 4; ++i)
+        skin[i] = vertex_weight.x * bone_texel(vertex_joint.x, i) +
+                  vertex_weight.y * bone_texel(vertex_joint.y, i) +
+                  vertex_weight.z * bone_texel(vertex_joint.z, i) +
+                  vertex_weight.w * bone_texel(vertex_joint.w, i);
+    vec3 Pskinned = (skin * vec4(position, 1.0)).xyz;
+    vec3 Nskinned = mat3(skin) * normal;
+#endif
 
     /* --------- to world space, then to clip space -------------------- */
-    vec4 Pworld = model * Pskinned;
+    vec4 Pworld = M * vec4(Pskinned, 1.0);
     gl_Position = projection * view * Pworld;
 
     /* --------- pass to fragment shader ------------------------------- */
     fragment.position = Pworld.xyz;
-    fragment.normal   = normalize(mat3(model) * Nskinned);
-    fragment.color    = vertex_color;          // keep original colour
+    fragment.normal   = normalize(mat3(M) * Nskinned);
+    fragment.color    = vec3(1.0);             // COLOR_0 is not loaded: white, as CGP filled it
     fragment.uv       = vertex_uv;
 }
\ No newline at end of file
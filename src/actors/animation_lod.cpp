@@ -0,0 +1,103 @@
+#include "animation_lod.hpp"
+#include "skinned_actor.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+char const* animation_tier_name(animation_tier tier)
+{
+    switch (tier) {
+    case animation_tier::reduced: return "reduced";
+    case animation_tier::frozen:  return "frozen";
+    default:                      return "full";
+    }
+}
+
+void animation_lod::begin_frame(cgp::mat4 const& view_, cgp::mat4 const& projection_, float dt_)
+{
+    view       = view_;
+    projection = projection_;
+    dt         = dt_ > 0 ? dt_ : dt;
+    ++frame;
+    for (std::atomic<int>& n : actors) n = 0;
+    updates   = 0;
+    update_ns = 0;
+}
+
+double animation_lod::saved_ms() const
+{
+    int total = 0;
+    for (std::atomic<int> const& n : actors) total += n;
+    int const done = updates;
+    if (done == 0) return 0;
+    return 1e-6 * double(update_ns) / done * (total - done);
+}
+
+animation_tier animation_lod::classify(skinned_actor const& actor, animation_tier current) const
+{
+    float distance = 0;
+    float const size = actor.projected_size(view, projection, &distance);
+    float const lo = 1.0f - hysteresis, hi = 1.0f + hysteresis;
+    // leave the current tier only past the margin, so that it does not flicker
+    float const scale_reduced = current == animation_tier::full   ? lo : hi;
+    float const scale_frozen  = current == animation_tier::frozen ? hi : lo;
+    if (distance > frozen_beyond * (current == animation_tier::frozen ? lo : hi)
+        || size < frozen_below * scale_frozen)
+        return animation_tier::frozen;
+    if (size < reduced_below * scale_reduced)
+        return animation_tier::reduced;
+    return animation_tier::full;
+}
+
+void animation_lod::timed_animate(skinned_actor& actor, float t)
+{
+    auto const t0 = std::chrono::steady_clock::now();
+    actor.animate(t);
+    update_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    ++updates;
+}
+
+void animation_lod::animate(skinned_actor& actor, size_t slot, float t)
+{
+    animation_lod_state& s = actor.anim_lod;
+    s.tier = enabled && actor.res != nullptr ? classify(actor, s.tier) : animation_tier::full;
+    ++actors[int(s.tier)];
+
+    switch (s.tier) {
+    case animation_tier::full:
+        if (!s.to.empty()) {        // back from a reduced rate: the last evaluated pose
+            actor.uBones.swap(s.to);
+            s.to.clear();
+        }
+        timed_animate(actor, t);
+        return;
+
+    case animation_tier::frozen:
+        return;
+
+    case animation_tier::reduced: {
+        int const n = std::max(interval, 1);
+        if (s.to.empty()) {         // just reduced: hold the pose until the actor's slot
+            s.to = s.from = actor.uBones;
+            s.t_from = s.t_to = t;
+        } else if ((frame + slot) % uint64_t(n) == 0) {
+            // from the shown pose to the one n frames ahead; uBones gets the
+            // last evaluated pose back first, evaluate_pose() only updates
+            // the joints that move
+            s.from = actor.uBones;
+            actor.uBones.swap(s.to);
+            timed_animate(actor, t + float(n) * dt);
+            s.to     = actor.uBones;
+            s.t_from = t;
+            s.t_to   = t + float(n) * dt;
+        }
+        float const a = s.t_to > s.t_from ? std::clamp((t - s.t_from) / (s.t_to - s.t_from), 0.0f, 1.0f) : 1.0f;
+        size_t const joints = std::min({ actor.uBones.size(), s.from.size(), s.to.size() });
+        for (size_t j = 0; j < joints; ++j)
+            for (int row = 0; row < 4; ++row)
+                for (int col = 0; col < 4; ++col)
+                    actor.uBones[j](row, col) = (1 - a) * s.from[j](row, col) + a * s.to[j](row, col);
+        return;
+    }
+    }
+}
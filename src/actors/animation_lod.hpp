@@ -0,0 +1,63 @@
+#pragma once
+// animation_lod.hpp
+// Update rate of the actors' animation by projected size and distance:
+//   - full    : animate() every frame
+//   - reduced : animate() every `interval` frames, for the pose `interval`
+//               frames ahead; the frames in between blend the skinning
+//               matrices from the shown pose to that one. Each actor has
+//               its own slot in the interval, so that the updates of a
+//               crowd are spread evenly over the frames.
+//   - frozen  : no update (a few pixels tall, or in the fog)
+// animation_lod::animate() may run on several threads at once, for
+// different actors.
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "cgp/cgp.hpp"
+
+struct skinned_actor;
+
+enum class animation_tier : int { full = 0, reduced = 1, frozen = 2 };
+constexpr int animation_tier_count = 3;
+/// "full", "reduced", "frozen"
+char const* animation_tier_name(animation_tier tier);
+
+/// Per actor: tier and the two poses of a reduced update
+struct animation_lod_state {
+    animation_tier         tier   = animation_tier::full;
+    float                  t_from = 0, t_to = 0;   ///< animation times of `from` and `to`
+    std::vector<cgp::mat4> from;                   ///< skinning matrices shown at t_from
+    std::vector<cgp::mat4> to;                     ///< last evaluated pose (empty: uBones is)
+};
+
+struct animation_lod {
+    bool  enabled       = true;
+    float reduced_below = 0.10f;   ///< projected height (fraction of the half screen)
+    float frozen_below  = 0.02f;
+    float frozen_beyond = 15.0f;   ///< camera distance, fully in the fog (fog_d_max)
+    float hysteresis    = 0.2f;    ///< relative margin around the thresholds
+    int   interval      = 4;       ///< frames between two updates of a reduced actor
+
+    /// Camera and time step of the frame; clears the statistics
+    void begin_frame(cgp::mat4 const& view, cgp::mat4 const& projection, float dt);
+    /// animate(t) of `actor` as its tier allows; `slot`: its place in the
+    /// interval (any number, e.g. its index)
+    void animate(skinned_actor& actor, size_t slot, float t);
+
+    /* ---- statistics of the frame ---------------------------------------- */
+    std::atomic<int>     actors[animation_tier_count] = {};
+    std::atomic<int>     updates   { 0 };   ///< animate() calls
+    std::atomic<int64_t> update_ns { 0 };   ///< their CPU time
+    /// CPU time of the animate() calls skipped, at the measured cost of one
+    double saved_ms() const;
+
+private:
+    animation_tier classify(skinned_actor const& actor, animation_tier current) const;
+    void           timed_animate(skinned_actor& actor, float t);
+
+    cgp::mat4 view       = cgp::mat4::build_identity();
+    cgp::mat4 projection = cgp::mat4::build_identity();
+    uint64_t  frame      = 0;
+    float     dt         = 1.0f / 60.0f;
+};
@@ -0,0 +1,43 @@
+#include "animation_player.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void animation_player::play(gltf_animation_set const& set, int clip_index, float t)
+{
+    if (clip_index < 0 || clip_index >= int(set.clips.size())) {
+        stop();
+        return;
+    }
+    clip  = clip_index;
+    start = t;
+    cursor.assign(set.clips[size_t(clip)].channel_count, 0);
+}
+
+float animation_player::clip_time(gltf_animation_set const& set, float t) const
+{
+    float const duration = set.clips[size_t(clip)].duration;
+    float const local    = speed * (t - start);
+    if (duration <= 0) return 0;
+    if (!loop) return std::min(std::max(local, 0.0f), duration);
+    float const wrapped = std::fmod(local, duration);
+    return wrapped < 0 ? wrapped + duration : wrapped;
+}
+
+void animation_player::sample(gltf_animation_set const& set, float t, skeleton_pose& pose)
+{
+    if (!playing()) return;
+    gltf_animation_clip const& c = set.clips[size_t(clip)];
+    float const local = clip_time(set, t);
+    for (uint32_t k = 0; k < c.channel_count; ++k) {
+        gltf_animation_channel const& channel = set.channels[c.first_channel + k];
+        if (size_t(channel.joint) >= pose.rotation.size()) continue;
+        float v[4];
+        gltf_sample_channel(set, channel, cursor[k], local, v);
+        switch (gltf_channel_path(channel.path)) {
+        case gltf_channel_path::translation: pose.set_translation(channel.joint, { v[0], v[1], v[2] });    break;
+        case gltf_channel_path::rotation:    pose.set_rotation(channel.joint, { v[0], v[1], v[2], v[3] }); break;
+        case gltf_channel_path::scale:       pose.set_scale(channel.joint, { v[0], v[1], v[2] });          break;
+        }
+    }
+}
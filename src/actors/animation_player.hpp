@@ -0,0 +1,30 @@
+#pragma once
+// animation_player.hpp
+// Playback of one glTF clip (gltf_animation.hpp) on an actor's pose: the
+// channels of the clip are sampled at the clip time and written to the
+// skeleton_pose, which only re-evaluates the joints whose value changed.
+// One cursor per channel keeps forward playback O(1) whatever the clip
+// length.
+
+#include <cstdint>
+#include <vector>
+#include "../loader/gltf_animation.hpp"
+#include "skeleton.hpp"
+
+struct animation_player {
+    int   clip  = -1;     ///< in the animation set, -1: stopped
+    float start = 0;      ///< time the clip started at
+    float speed = 1;
+    bool  loop  = true;   ///< otherwise the last key is held
+    std::vector<uint32_t> cursor;   ///< per channel of the clip
+
+    /// Play `clip` of `set` from time `t`
+    void play(gltf_animation_set const& set, int clip, float t);
+    void stop() { clip = -1; }
+    bool playing() const { return clip >= 0; }
+
+    /// Clip time at time `t`
+    float clip_time(gltf_animation_set const& set, float t) const;
+    /// Write the clip at time `t` into `pose` (evaluate it afterwards)
+    void sample(gltf_animation_set const& set, float t, skeleton_pose& pose);
+};
@@ -0,0 +1,86 @@
+#include "baked_animation.hpp"
+#include "skinned_actor.hpp"
+#include "../utils/timing.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+baked_animation::baked_animation()
+{
+    glGenBuffers(1, &buffer);
+    glGenTextures(1, &tex);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+baked_animation::~baked_animation()
+{
+    if (!gl_context_alive()) return;
+    glDeleteTextures(1, &tex);
+    glDeleteBuffers(1, &buffer);
+}
+
+bool baked_animation::bake(skinned_actor& actor, int frame_count, skinning_mode layout)
+{
+    auto const t0 = std::chrono::steady_clock::now();
+    frames = 0;
+    float const T = actor.animation_period();
+    if (T <= 0 || frame_count < 2 || actor.uBones.empty())
+        return false;
+
+    period = T;
+    joints = int(actor.uBones.size());
+    mode   = layout;
+    std::vector<cgp::mat4> const bones = actor.uBones;   // given back after sampling
+    skeleton_pose const          pose  = actor.pose;
+    std::vector<float> data;
+    data.reserve(size_t(frame_count) * size_t(stride()) * 4);
+    for (int f = 0; f < frame_count; ++f) {
+        actor.animate(T * float(f) / float(frame_count));
+        append_skinning_texels(data, actor.uBones.data(), actor.uBones.size(), mode);
+    }
+    actor.uBones = bones;
+    actor.pose   = pose;
+    if (mode == skinning_mode::dual_quaternion) {
+        // q and -q are the same rotation: keep each joint in the hemisphere
+        // of its previous frame, so that the shader can blend two frames
+        size_t const frame_floats = 4 * size_t(stride());
+        for (size_t f = 1; f < size_t(frame_count); ++f)
+            for (size_t j = 0; j < size_t(joints); ++j) {
+                float const* prev = &data[(f - 1) * frame_floats + 8 * j];
+                float*       dq   = &data[f * frame_floats + 8 * j];
+                if (prev[0]*dq[0] + prev[1]*dq[1] + prev[2]*dq[2] + prev[3]*dq[3] < 0)
+                    for (int i = 0; i < 8; ++i) dq[i] = -dq[i];
+            }
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(data.size() * sizeof(float)), data.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    frames    = frame_count;
+    gpu_bytes = data.size() * sizeof(float);
+    bake_ms   = elapsed_ms(t0);
+    std::cout << "[baked_animation] " << frames << " frames of " << period << " s, " << joints
+              << " joints (" << skinning_name(mode) << "): " << gpu_bytes / 1024 << " KiB in "
+              << bake_ms << " ms" << std::endl;
+    return true;
+}
+
+void baked_animation::bind(int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + GLenum(unit));
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+float baked_animation::phase_at(float t) const
+{
+    if (period <= 0) return 0;
+    double const p = double(t) / double(period);
+    return float(p - std::floor(p));
+}
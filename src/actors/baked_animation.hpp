@@ -0,0 +1,49 @@
+#pragma once
+// baked_animation.hpp
+// One period of an actor's procedural animation (animate(t), see
+// skinned_actor::animation_period) sampled once into a texture buffer of
+// skinning matrices: `frames` poses of |J| bones in the layout of a
+// skinning_mode, uploaded with a single glBufferData. turtle.vert.glsl reads
+// it for the instances whose record carries a phase (bone_palette::add_instance),
+// blending the two frames around uBakedTime + phase: such a crowd costs no
+// animate() and no palette space per frame. Actors under interactive
+// control (clips, gameplay) keep the live path.
+// OpenGL thread only.
+
+#include <cstddef>
+#include "cgp/cgp.hpp"
+#include "../loader/bone_palette.hpp"
+
+struct skinned_actor;
+
+struct baked_animation {
+    baked_animation();
+    baked_animation(baked_animation const&)            = delete;
+    baked_animation& operator=(baked_animation const&) = delete;
+    ~baked_animation();
+
+    /**
+     * Sample `frame_count` poses of one period of `actor` (its animate(); its
+     * pose is given back afterwards) in the layout of `layout`.
+     * @return false, the bake being emptied, if its animation is not periodic
+     */
+    bool bake(skinned_actor& actor, int frame_count, skinning_mode layout);
+    /// Bind the texture buffer to `unit`
+    void bind(int unit) const;
+
+    bool  ready()  const { return frames > 0; }
+    /// Texels per frame (uBakedStride)
+    int   stride() const { return joints * skinning_texels(mode); }
+    /// Time `t` in periods, in [0, 1) (uBakedTime)
+    float phase_at(float t) const;
+
+    float         period = 0;    ///< of the animation (s)
+    int           frames = 0;    ///< in one period
+    int           joints = 0;
+    skinning_mode mode   = skinning_mode::matrix;
+    size_t        gpu_bytes = 0;
+    double        bake_ms   = 0;   ///< CPU time of the last bake (sampling + upload)
+
+private:
+    GLuint buffer = 0, tex = 0;
+};
@@ -0,0 +1,157 @@
+#include "broadphase.hpp"
+#include "../utils/thread_pool.hpp"
+#include "../utils/timing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr uint32_t not_inserted = ~uint32_t(0);
+/// Bodies per range of a pooled find_pairs
+constexpr size_t pair_grain = 512;
+
+/// The 13 neighbours "after" a cell (the other 13 are their opposites)
+constexpr int forward_cells[13][3] = {
+    { 1, 0, 0 },
+    { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+    { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+    { -1,  0, 1 }, { 0,  0, 1 }, { 1,  0, 1 },
+    { -1,  1, 1 }, { 0,  1, 1 }, { 1,  1, 1 } };
+
+inline bool spheres_overlap(cgp::vec3 const& a, float ra, cgp::vec3 const& b, float rb)
+{
+    cgp::vec3 const d = b - a;
+    float const r = ra + rb;
+    return d.x*d.x + d.y*d.y + d.z*d.z <= r * r;
+}
+
+} // namespace
+
+hash_grid_broadphase::cell_key hash_grid_broadphase::key_of(cgp::vec3 const& p) const
+{
+    return { int32_t(std::floor(p.x / cell)), int32_t(std::floor(p.y / cell)), int32_t(std::floor(p.z / cell)) };
+}
+
+size_t hash_grid_broadphase::bucket_of(cell_key const& k) const
+{
+    // large primes, the usual spatial hash
+    uint32_t const h = uint32_t(k.x) * 73856093u ^ uint32_t(k.y) * 19349663u ^ uint32_t(k.z) * 83492791u;
+    return size_t(h) & mask;
+}
+
+void hash_grid_broadphase::build(cgp::vec3 const* center, float const* radius, size_t count)
+{
+    auto const t0 = std::chrono::steady_clock::now();
+    float largest = 0;
+    for (size_t i = 0; i < count; ++i) largest = std::max(largest, radius[i]);
+    cell = std::max(min_cell_size, 2 * largest);
+
+    size_t table = 64;
+    while (table < 2 * count) table *= 2;   // about half the buckets empty
+    mask = table - 1;
+
+    // counting sort of the bodies by bucket
+    first.assign(table + 1, 0);
+    bucket.resize(count);
+    bodies = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (radius[i] <= 0) { bucket[i] = not_inserted; continue; }
+        bucket[i] = uint32_t(bucket_of(key_of(center[i])));
+        ++first[bucket[i] + 1];
+        ++bodies;
+    }
+    cells = 0;
+    for (size_t b = 0; b < table; ++b) {
+        cells    += first[b + 1] > 0 ? 1 : 0;
+        first[b + 1] += first[b];
+    }
+    sorted.resize(bodies);
+    sorted_cell.resize(bodies);
+    sorted_center.resize(bodies);
+    sorted_radius.resize(bodies);
+    for (size_t i = 0; i < count; ++i) {   // leaves first[b] at the end of bucket b
+        if (bucket[i] == not_inserted) continue;
+        uint32_t const s = first[bucket[i]]++;
+        sorted[s]        = uint32_t(i);
+        sorted_cell[s]   = key_of(center[i]);
+        sorted_center[s] = center[i];
+        sorted_radius[s] = radius[i];
+    }
+    for (size_t b = table; b > 0; --b) first[b] = first[b - 1];   // back to the starts
+    first[0] = 0;
+    build_ms = elapsed_ms(t0);
+}
+
+void hash_grid_broadphase::pairs_of(uint32_t s, std::vector<broadphase_pair>& out, size_t& tested) const
+{
+    cell_key const k = sorted_cell[s];
+    cgp::vec3 const c = sorted_center[s];
+    float const r = sorted_radius[s];
+    auto test = [&](uint32_t t) {
+        ++tested;
+        if (spheres_overlap(c, r, sorted_center[t], sorted_radius[t]))
+            out.push_back({ std::min(sorted[s], sorted[t]), std::max(sorted[s], sorted[t]) });
+    };
+
+    // its own cell: the bodies after it in the bucket
+    size_t const own = bucket_of(k);
+    for (uint32_t t = s + 1; t < first[own + 1]; ++t)
+        if (sorted_cell[t] == k) test(t);
+    // half of the neighbours: the other half finds the pairs with this cell
+    for (int const* d : forward_cells) {
+        cell_key const n = { k.x + d[0], k.y + d[1], k.z + d[2] };
+        size_t const b = bucket_of(n);
+        for (uint32_t t = first[b]; t < first[b + 1]; ++t)
+            if (sorted_cell[t] == n) test(t);   // skips the other cells of the bucket
+    }
+}
+
+void hash_grid_broadphase::find_pairs(std::vector<broadphase_pair>& out, thread_pool* pool)
+{
+    auto const t0 = std::chrono::steady_clock::now();
+    out.clear();
+    tests = 0;
+    if (pool == nullptr) {
+        for (size_t s = 0; s < bodies; ++s)
+            pairs_of(uint32_t(s), out, tests);
+    } else {
+        // one output per range (at most size() + 1 of them), kept from frame to frame
+        range_pairs.resize(std::max(range_pairs.size(), pool->size() + 1));
+        std::atomic<size_t> next_range{ 0 }, all_tests{ 0 };
+        pool->parallel_for(bodies, [&](size_t begin, size_t end) {
+            std::vector<broadphase_pair>& local = range_pairs[next_range++];
+            local.clear();
+            size_t tested = 0;
+            for (size_t s = begin; s < end; ++s)
+                pairs_of(uint32_t(s), local, tested);
+            all_tests += tested;
+        }, pair_grain);
+        for (size_t r = 0; r < next_range; ++r)
+            out.insert(out.end(), range_pairs[r].begin(), range_pairs[r].end());
+        tests = all_tests;
+    }
+    pairs    = out.size();
+    pairs_ms = elapsed_ms(t0);
+}
+
+void hash_grid_broadphase::query(cgp::vec3 const& p, float r, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    if (bodies == 0) return;
+    // a body overlapping the sphere has its center within r + cell / 2 of p
+    float const reach = r + 0.5f * cell;
+    cell_key const lo = key_of(p - cgp::vec3{ reach, reach, reach });
+    cell_key const hi = key_of(p + cgp::vec3{ reach, reach, reach });
+    for (int32_t z = lo.z; z <= hi.z; ++z)
+        for (int32_t y = lo.y; y <= hi.y; ++y)
+            for (int32_t x = lo.x; x <= hi.x; ++x) {
+                cell_key const n = { x, y, z };
+                size_t const b = bucket_of(n);
+                for (uint32_t t = first[b]; t < first[b + 1]; ++t)
+                    if (sorted_cell[t] == n && spheres_overlap(p, r, sorted_center[t], sorted_radius[t]))
+                        out.push_back(sorted[t]);
+            }
+}
@@ -0,0 +1,68 @@
+#pragma once
+// broadphase.hpp
+// Uniform hash grid over bounding spheres, rebuilt every frame: the
+// candidate pairs handed to a narrowphase (shark_collision, separation of
+// NPCs) instead of testing all n^2 pairs.
+// Each body goes into the cell of its center; cells are as wide as the
+// largest sphere, so that two overlapping spheres are at most one cell
+// apart: a body is only tested against those of its cell and of half of
+// the 26 around it. Cells are hashed into a power-of-two table, and the
+// bodies sorted by bucket with a counting sort (their spheres copied in
+// that order): once warm, build() and a find_pairs() without a pool
+// allocate nothing (a pooled one allocates the jobs of parallel_for).
+// Bodies are identified by their index in the arrays given to build
+// (e.g. npc_manager slots).
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "cgp/cgp.hpp"
+
+struct thread_pool;
+
+/// Two bodies whose spheres overlap, a < b
+struct broadphase_pair { uint32_t a, b; };
+
+struct hash_grid_broadphase {
+    float min_cell_size = 1.0f;   ///< the cells are at least this wide
+
+    /// Sort the `count` spheres (`center`, `radius`) into cells (copied);
+    /// radius <= 0: no body (a dead slot)
+    void build(cgp::vec3 const* center, float const* radius, size_t count);
+    /// Every pair of overlapping spheres into `out` (cleared first), on the
+    /// workers of `pool` and the calling thread if given (any order then)
+    void find_pairs(std::vector<broadphase_pair>& out, thread_pool* pool = nullptr);
+    /// Bodies whose sphere overlaps (`center`, `radius`) into `out` (cleared first)
+    void query(cgp::vec3 const& center, float radius, std::vector<uint32_t>& out) const;
+
+    /* ---- statistics of the last build / find_pairs ----------------------- */
+    size_t bodies   = 0;   ///< inserted
+    size_t cells    = 0;   ///< occupied
+    size_t tests    = 0;   ///< sphere tests of find_pairs
+    size_t pairs    = 0;   ///< found
+    double build_ms = 0;
+    double pairs_ms = 0;
+    float  cell_size() const { return cell; }
+
+private:
+    struct cell_key {
+        int32_t x, y, z;
+        bool operator==(cell_key const& o) const { return x == o.x && y == o.y && z == o.z; }
+    };
+    cell_key key_of(cgp::vec3 const& p) const;
+    size_t   bucket_of(cell_key const& k) const;
+    /// Pairs of the body in sorted slot s with those after it in its cell and
+    /// in the 13 cells "after" its own (half of the neighbourhood: each pair once)
+    void     pairs_of(uint32_t s, std::vector<broadphase_pair>& out, size_t& tested) const;
+
+    float                  cell = 0;
+    size_t                 mask = 0;           ///< table size - 1
+    std::vector<uint32_t>  first;              ///< per bucket, its first slot (+1 sentinel)
+    std::vector<uint32_t>  bucket;             ///< per body, ~0 if not inserted
+    // bodies sorted by bucket, copied for locality
+    std::vector<uint32_t>  sorted;             ///< body index
+    std::vector<cell_key>  sorted_cell;
+    std::vector<cgp::vec3> sorted_center;
+    std::vector<float>     sorted_radius;
+    std::vector<std::vector<broadphase_pair>> range_pairs;   ///< per range of a pooled find_pairs
+};
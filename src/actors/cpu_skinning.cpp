@@ -0,0 +1,212 @@
+#include "cpu_skinning.hpp"
+#include "skinned_actor.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+// The AVX2 kernel is built whatever the flags (GCC / Clang on x86: as a
+// target("avx2") function) and picked at run time if the CPU has AVX2
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CPU_SKIN_AVX2
+#define CPU_SKIN_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__AVX2__)   // MSVC /arch:AVX2
+#include <immintrin.h>
+#define CPU_SKIN_AVX2
+#define CPU_SKIN_AVX2_TARGET
+#endif
+
+namespace {
+
+/// Inputs of one skinning pass, shared by its ranges
+struct skin_job {
+    cgp::vec3 const*  position;
+    cgp::vec3 const*  normal;
+    cgp::uint4 const* joints;    ///< nullptr: no skin data, every vertex on joint 0
+    cgp::vec4 const*  weights;
+    size_t            skinned;   ///< vertices with joints / weights
+    float const*      bones;     ///< 16 floats per joint: its columns (as the shader's mat4)
+    size_t            bone_count;
+    cgp::vec3*        out_position;
+    cgp::vec3*        out_normal;
+};
+
+/// Influences of vertex v as the shader sees them (pack_skin_vertices):
+/// weights summing to 1, joint 0 when there is no skin; joints outside the
+/// pose are dropped
+inline void influences(skin_job const& job, size_t v, uint32_t j[4], float w[4])
+{
+    if (v >= job.skinned) {
+        j[0] = j[1] = j[2] = j[3] = 0;
+        w[0] = 1; w[1] = w[2] = w[3] = 0;
+        return;
+    }
+    float sum = 0;
+    for (int k = 0; k < 4; ++k) {
+        j[k] = job.joints[v][k];
+        w[k] = j[k] < job.bone_count ? job.weights[v][k] : 0.0f;
+        if (j[k] >= job.bone_count) j[k] = 0;
+        sum += w[k];
+    }
+    if (sum > 0) {
+        for (int k = 0; k < 4; ++k) w[k] /= sum;
+    } else {
+        j[0] = 0; w[0] = 1;
+    }
+}
+
+inline cgp::vec3 unit_or_zero(cgp::vec3 const& n)
+{
+    float const l = std::sqrt(n.x*n.x + n.y*n.y + n.z*n.z);
+    return l > 0 ? n / l : n;
+}
+
+void skin_range_scalar(skin_job const& job, size_t first, size_t last)
+{
+    for (size_t v = first; v < last; ++v) {
+        uint32_t j[4];
+        float    w[4];
+        influences(job, v, j, w);
+        float S[16] = {};
+        for (int k = 0; k < 4; ++k) {
+            float const* B = job.bones + 16 * size_t(j[k]);
+            for (int i = 0; i < 16; ++i)
+                S[i] += w[k] * B[i];
+        }
+        cgp::vec3 const& p = job.position[v];
+        cgp::vec3 const& n = job.normal[v];
+        job.out_position[v] = { S[0]*p.x + S[4]*p.y + S[8]*p.z  + S[12],
+                                S[1]*p.x + S[5]*p.y + S[9]*p.z  + S[13],
+                                S[2]*p.x + S[6]*p.y + S[10]*p.z + S[14] };
+        job.out_normal[v] = unit_or_zero({ S[0]*n.x + S[4]*n.y + S[8]*n.z,
+                                           S[1]*n.x + S[5]*n.y + S[9]*n.z,
+                                           S[2]*n.x + S[6]*n.y + S[10]*n.z });
+    }
+}
+
+#if defined(CPU_SKIN_AVX2)
+// The blended matrix in two registers: columns 0|1 and 2|3. P is then
+// lo * (x,x,x,x, y,y,y,y) + hi * (z,z,z,z, 1,1,1,1), folded to 128 bits.
+CPU_SKIN_AVX2_TARGET void skin_range_avx2(skin_job const& job, size_t first, size_t last)
+{
+    for (size_t v = first; v < last; ++v) {
+        uint32_t j[4];
+        float    w[4];
+        influences(job, v, j, w);
+        __m256 lo = _mm256_setzero_ps(), hi = _mm256_setzero_ps();
+        for (int k = 0; k < 4; ++k) {
+            float const* B  = job.bones + 16 * size_t(j[k]);
+            __m256 const wk = _mm256_set1_ps(w[k]);
+            lo = _mm256_add_ps(lo, _mm256_mul_ps(wk, _mm256_loadu_ps(B)));
+            hi = _mm256_add_ps(hi, _mm256_mul_ps(wk, _mm256_loadu_ps(B + 8)));
+        }
+        cgp::vec3 const& p = job.position[v];
+        cgp::vec3 const& n = job.normal[v];
+        __m256 const tp = _mm256_add_ps(
+            _mm256_mul_ps(lo, _mm256_setr_ps(p.x, p.x, p.x, p.x, p.y, p.y, p.y, p.y)),
+            _mm256_mul_ps(hi, _mm256_setr_ps(p.z, p.z, p.z, p.z, 1, 1, 1, 1)));
+        __m256 const tn = _mm256_add_ps(
+            _mm256_mul_ps(lo, _mm256_setr_ps(n.x, n.x, n.x, n.x, n.y, n.y, n.y, n.y)),
+            _mm256_mul_ps(hi, _mm256_setr_ps(n.z, n.z, n.z, n.z, 0, 0, 0, 0)));
+        alignas(16) float P[4], N[4];
+        _mm_store_ps(P, _mm_add_ps(_mm256_castps256_ps128(tp), _mm256_extractf128_ps(tp, 1)));
+        _mm_store_ps(N, _mm_add_ps(_mm256_castps256_ps128(tn), _mm256_extractf128_ps(tn, 1)));
+        job.out_position[v] = { P[0], P[1], P[2] };
+        job.out_normal[v]   = unit_or_zero({ N[0], N[1], N[2] });
+    }
+}
+#endif
+
+/// The CPU runs the AVX2 kernel (checked once)
+bool has_avx2()
+{
+#if defined(CPU_SKIN_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    static bool const avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#elif defined(CPU_SKIN_AVX2)
+    return true;   // built for it
+#else
+    return false;
+#endif
+}
+
+void skin_range(skin_job const& job, size_t first, size_t last, cpu_skin_path path)
+{
+#if defined(CPU_SKIN_AVX2)
+    if (path == cpu_skin_path::fast && has_avx2()) { skin_range_avx2(job, first, last); return; }
+#endif
+    (void)path;
+    skin_range_scalar(job, first, last);
+}
+
+void range_bounds(cgp::vec3 const* p, size_t first, size_t last, cgp::vec3& pmin, cgp::vec3& pmax)
+{
+    for (size_t v = first; v < last; ++v)
+        for (int c = 0; c < 3; ++c) {
+            pmin[c] = std::min(pmin[c], p[v][c]);
+            pmax[c] = std::max(pmax[c], p[v][c]);
+        }
+}
+
+/// Below this, a range is not worth a job
+constexpr size_t min_range_vertices = 2048;
+
+} // namespace
+
+char const* cpu_skin_fast_kernel()
+{
+    return has_avx2() ? "AVX2" : "scalar";
+}
+
+void cpu_skin(ActorResources const& res, std::vector<cgp::mat4> const& bones, cpu_skinned_mesh& out,
+              thread_pool* pool, cpu_skin_path path)
+{
+    size_t const n = res.geometry.position.size();
+    out.position.resize(n);
+    out.normal.resize(n);
+    out.bounds_min = out.bounds_max = { 0, 0, 0 };
+    if (n == 0 || bones.empty()) return;
+
+    // columns of each bone, as the palette sends them (bone_palette::add, matrix)
+    std::vector<float> columns(16 * bones.size());
+    for (size_t b = 0; b < bones.size(); ++b)
+        for (int col = 0; col < 4; ++col)
+            for (int row = 0; row < 4; ++row)
+                columns[16 * b + 4 * col + row] = bones[b](row, col);
+
+    bool const has_normals = res.geometry.normal.size() == n;
+    std::vector<cgp::vec3> flat_normals;   // so that the kernels need no test
+    if (!has_normals) flat_normals.assign(n, { 0, 0, 1 });
+
+    skin_job job;
+    job.position     = &res.geometry.position[0];
+    job.normal       = has_normals ? &res.geometry.normal[0] : flat_normals.data();
+    job.skinned      = std::min(res.joint_index.size(), res.joint_weight.size());
+    job.joints       = job.skinned > 0 ? &res.joint_index[0] : nullptr;
+    job.weights      = job.skinned > 0 ? &res.joint_weight[0] : nullptr;
+    job.skinned      = std::min(job.skinned, n);
+    job.bones        = columns.data();
+    job.bone_count   = bones.size();
+    job.out_position = out.position.data();
+    job.out_normal   = out.normal.data();
+
+    float const inf = std::numeric_limits<float>::max();
+    out.bounds_min = { inf, inf, inf };
+    out.bounds_max = { -inf, -inf, -inf };
+    std::mutex bounds_mutex;
+    auto run = [&](size_t first, size_t last) {
+        cgp::vec3 pmin = { inf, inf, inf }, pmax = { -inf, -inf, -inf };
+        skin_range(job, first, last, path);
+        range_bounds(job.out_position, first, last, pmin, pmax);
+        std::lock_guard<std::mutex> lock(bounds_mutex);
+        range_bounds(&pmin, 0, 1, out.bounds_min, out.bounds_max);
+        range_bounds(&pmax, 0, 1, out.bounds_min, out.bounds_max);
+    };
+    if (pool)
+        pool->parallel_for(n, run, min_range_vertices);
+    else
+        run(0, n);
+}
@@ -0,0 +1,38 @@
+#pragma once
+// cpu_skinning.hpp
+// Linear-blend skinning on the CPU, the same math as the 4x4 matrix path of
+// turtle.vert.glsl: ActorResources::geometry deformed by a pose (uBones) into
+// plain position / normal arrays, for exact bounds, mesh-level collision and
+// headless checks. Weights are normalized as pack_skin_vertices does, and
+// vertices without skin data follow joint 0.
+//   - fast   : one vertex per iteration in AVX2 registers when the CPU has
+//              them (chosen at run time, no -mavx2 needed), the scalar loop otherwise
+//   - scalar : reference, for checks / benchmarks
+// Any thread; with a thread_pool the vertices are split into ranges.
+
+#include <vector>
+#include "cgp/cgp.hpp"
+
+struct ActorResources;
+struct thread_pool;
+
+enum class cpu_skin_path { fast, scalar };
+
+/// Deformed copy of a mesh
+struct cpu_skinned_mesh {
+    std::vector<cgp::vec3> position;
+    std::vector<cgp::vec3> normal;       ///< unit length
+    cgp::vec3 bounds_min = { 0, 0, 0 };  ///< of position (model space)
+    cgp::vec3 bounds_max = { 0, 0, 0 };
+};
+
+/// "AVX2" or "scalar": the kernel behind cpu_skin_path::fast on this CPU
+char const* cpu_skin_fast_kernel();
+
+/**
+ * Skin `res.geometry` with `bones` (|J| matrices, uBones) into `out`.
+ * `pool`: run the vertex ranges on its workers, the caller taking one too
+ * (returns when all are done).
+ */
+void cpu_skin(ActorResources const& res, std::vector<cgp::mat4> const& bones, cpu_skinned_mesh& out,
+              thread_pool* pool = nullptr, cpu_skin_path path = cpu_skin_path::fast);
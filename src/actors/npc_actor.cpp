@@ -2,8 +2,7 @@
 #include "cgp/cgp.hpp"
 
 bool npc_actor::check_for_end_of_life(){
-    float tol = 0.5;
-    return cgp::norm(drawable.model.translation - target) <= tol;
+    return npc_arrived(drawable.model.translation, target);
 }
 
 /**
@@ -11,12 +10,8 @@ bool npc_actor::check_for_end_of_life(){
  */
 void npc_actor::update_position(float dt)
 {
-    cgp::vec3 dir = target - origin;
-    float dist = cgp::norm(dir);
-    if (dist < 1e-4f) return;
-
-    dir /= dist;            // normalize
-    origin += dir * speed * dt;
+    cgp::vec3 dir;
+    if (!npc_step(origin, target, speed, dt, dir)) return;
     drawable.model.translation = origin;
     align_to(dir);
 }
\ No newline at end of file
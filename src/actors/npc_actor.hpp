@@ -3,6 +3,28 @@
 #include "skinned_actor.hpp"
 #include "cgp/cgp.hpp"
 
+/// Distance to its target below which an NPC's life ends
+constexpr float npc_end_of_life_distance = 0.5f;
+
+/// One step of update_position: `position` moved by speed * dt towards
+/// `target`, `dir` set to the unit direction; false (nothing changed) once
+/// it is there. Shared with npc_manager's batched loop.
+inline bool npc_step(cgp::vec3& position, cgp::vec3 const& target, float speed, float dt, cgp::vec3& dir)
+{
+    dir = target - position;
+    float const dist = cgp::norm(dir);
+    if (dist < 1e-4f) return false;
+    dir /= dist;
+    position += dir * speed * dt;
+    return true;
+}
+
+/// check_for_end_of_life of an NPC at `position`
+inline bool npc_arrived(cgp::vec3 const& position, cgp::vec3 const& target)
+{
+    return cgp::norm(position - target) <= npc_end_of_life_distance;
+}
+
 /// A specialized skinned_actor with autonomous swimming behavior
 struct npc_actor : public skinned_actor {
     virtual ~npc_actor() = default;
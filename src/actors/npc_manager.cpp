@@ -0,0 +1,214 @@
+#include "npc_manager.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// Quaternion (x, y, z, w) of the shortest rotation taking unit `from` to unit `to`
+cgp::vec4 turn_towards(cgp::vec3 const& from, cgp::vec3 const& to)
+{
+    float const c = dot(from, to);
+    if (c < -1.0f + 1e-6f) {   // half turn, about any axis orthogonal to `from`
+        cgp::vec3 axis = cross(from, cgp::vec3{ 1, 0, 0 });
+        if (norm(axis) < 1e-3f) axis = cross(from, cgp::vec3{ 0, 1, 0 });
+        axis = normalize(axis);
+        return { axis.x, axis.y, axis.z, 0.0f };
+    }
+    // (from x to, 1 + c) normalized: stays accurate close to a half turn
+    cgp::vec3 const a = cross(from, to);
+    float const l = std::sqrt(dot(a, a) + (1 + c) * (1 + c));
+    return { a.x / l, a.y / l, a.z / l, (1 + c) / l };
+}
+
+/// Poses in the swim cycle of a species
+constexpr int baked_frames = 96;
+/// Slots per range of update() on a thread_pool
+constexpr size_t update_grain = 1024;
+
+} // namespace
+
+int npc_manager::add_species(npc_actor& prototype, cgp::vec3 const& forward)
+{
+    kinds.emplace_back();
+    kinds.back().prototype = &prototype;
+    kinds.back().forward   = normalize(forward);
+    if (prototype.res) {   // the box at any orientation
+        cgp::affine const& model = prototype.drawable.model;
+        cgp::vec3 const s = model.scaling * model.scaling_xyz;
+        kinds.back().radius = std::max({ s.x, s.y, s.z })
+                            * (norm(prototype.res->half_extents) + norm(prototype.res->center_offset));
+    }
+    return int(kinds.size()) - 1;
+}
+
+void npc_manager::reserve(size_t n)
+{
+    position.reserve(n);
+    target.reserve(n);
+    speed.reserve(n);
+    orientation.reserve(n);
+    phase.reserve(n);
+    radius.reserve(n);
+    species.reserve(n);
+    alive.reserve(n);
+    level.reserve(n);
+    arrived.reserve(n);
+    free_slots.reserve(n);
+    arrived_list.reserve(n);
+}
+
+npc_manager::handle npc_manager::spawn(int kind, cgp::vec3 const& origin, cgp::vec3 const& goal,
+                                       float swim_speed, float cycle_phase)
+{
+    handle h;
+    if (!free_slots.empty()) {
+        h = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        h = handle(alive.size());
+        position.emplace_back();
+        target.emplace_back();
+        speed.emplace_back();
+        orientation.emplace_back();
+        phase.emplace_back();
+        radius.emplace_back();
+        species.emplace_back();
+        alive.emplace_back();
+        level.emplace_back();
+        arrived.emplace_back();
+    }
+    species[h] = uint8_t(kind);
+    phase[h]   = cycle_phase - std::floor(cycle_phase);
+    radius[h]  = kinds[size_t(kind)].radius;
+    level[h]   = 0;
+    alive[h]   = 1;
+    ++live;
+    respawn(h, origin, goal, swim_speed);
+    return h;
+}
+
+void npc_manager::respawn(handle h, cgp::vec3 const& origin, cgp::vec3 const& goal, float swim_speed)
+{
+    position[h] = origin;
+    target[h]   = goal;
+    speed[h]    = swim_speed;
+    arrived[h]  = 0;
+    cgp::vec3 const d = goal - origin;
+    float const l = norm(d);
+    orientation[h] = l > 1e-4f ? turn_towards(kinds[species[h]].forward, d / l) : cgp::vec4{ 0, 0, 0, 1 };
+}
+
+void npc_manager::kill(handle h)
+{
+    if (h >= alive.size() || !alive[h]) return;
+    alive[h]  = 0;
+    radius[h] = 0;
+    free_slots.push_back(h);
+    --live;
+}
+
+void npc_manager::clear()
+{
+    for (size_t h = alive.size(); h-- > 0;)   // the lowest slots are taken first again
+        kill(handle(h));
+}
+
+void npc_manager::update(float dt, thread_pool* pool)
+{
+    // each range writes its own slots only
+    auto step = [this, dt](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            if (!alive[i]) continue;
+            cgp::vec3 dir;
+            if (npc_step(position[i], target[i], speed[i], dt, dir))
+                orientation[i] = turn_towards(kinds[species[i]].forward, dir);
+            arrived[i] = npc_arrived(position[i], target[i]);
+        }
+    };
+    if (pool)
+        pool->parallel_for(alive.size(), step, update_grain);
+    else
+        step(0, alive.size());
+
+    arrived_list.clear();
+    for (size_t i = 0; i < alive.size(); ++i)
+        if (alive[i] && arrived[i]) arrived_list.push_back(handle(i));
+}
+
+cgp::mat4 npc_manager::model_matrix(handle h) const
+{
+    cgp::affine const& model = kinds[species[h]].prototype->drawable.model;
+    return gltf_trs_matrix(position[h], orientation[h], model.scaling * model.scaling_xyz);
+}
+
+void npc_manager::publish(bone_palette& palette, cgp::mat4 const& view, cgp::mat4 const& projection,
+                          float lod_bias, float t)
+{
+    time = t;
+    batches.clear();
+    for (kind_data& K : kinds) {
+        npc_actor& P = *K.prototype;
+        for (std::vector<handle>& at : K.at_level) at.clear();
+        if (P.res == nullptr) continue;
+        K.at_level.resize(std::max(K.at_level.size(), P.res->lods.size()));
+        bool const stale = !K.cycle || !K.cycle->ready() || K.cycle->mode != P.skinning;
+        if (stale && P.animation_period() > 0) {
+            if (!K.cycle) K.cycle = std::make_unique<baked_animation>();
+            K.cycle->bake(P, baked_frames, P.skinning);
+        }
+    }
+
+    // level of each NPC from its projected bounding sphere, as select_lod
+    for (size_t i = 0; i < alive.size(); ++i) {
+        if (!alive[i]) continue;
+        kind_data& K = kinds[species[i]];
+        ActorResources const* R = K.prototype->res.get();
+        if (R == nullptr) continue;
+        cgp::affine const& model = K.prototype->drawable.model;
+        cgp::vec3 const s = model.scaling * model.scaling_xyz;
+        cgp::vec3 const c = R->center_offset;
+        cgp::vec4 const center = view * (model_matrix(handle(i)) * cgp::vec4{ c.x, c.y, c.z, 1.0f });
+        float const depth = -center.z;
+        float const size  = depth > 1e-3f ? R->radius * std::max({ s.x, s.y, s.z }) * projection(1, 1) / depth : 0.0f;
+        level[i] = uint8_t(skinned_actor::lod_for_size(lod_bias * size, level[i], int(R->lods.size())));
+        K.at_level[level[i]].push_back(handle(i));
+    }
+
+    // the records of a species and level are consecutive: its instance table
+    for (size_t k = 0; k < kinds.size(); ++k) {
+        kind_data const& K = kinds[k];
+        bool const baked = K.cycle && K.cycle->ready() && K.cycle->mode == K.prototype->skinning;
+        for (size_t l = 0; l < K.at_level.size(); ++l) {
+            if (K.at_level[l].empty()) continue;
+            int table = -1;
+            for (handle h : K.at_level[l]) {
+                // not periodic: every NPC in the prototype's pose of the frame
+                int const record = baked ? palette.add_instance(model_matrix(h), 0, phase[h])
+                                         : palette.add_instance(model_matrix(h), K.prototype->bone_offset);
+                if (table < 0) table = record;
+            }
+            batches.push_back({ int(k), int(l), table, int(K.at_level[l].size()) });
+        }
+    }
+}
+
+size_t npc_manager::draw(cgp::environment_generic_structure const& environment, bool wireframe) const
+{
+    size_t triangles = 0;
+    for (batch const& b : batches) {
+        kind_data const& K = kinds[size_t(b.kind)];
+        triangles += K.prototype->draw_instanced(environment, b.table, b.count, wireframe,
+                                                 K.cycle.get(), time, b.level);
+    }
+    return triangles;
+}
+
+size_t npc_manager::draw_calls() const
+{
+    size_t calls = 0;
+    for (batch const& b : batches)
+        calls += kinds[size_t(b.kind)].prototype->draw_calls(b.level);
+    return calls;
+}
@@ -0,0 +1,98 @@
+#pragma once
+// npc_manager.hpp
+// Every roaming NPC of the scene, sharks and other species, in one pool of
+// slots kept as structure-of-arrays: position, target, speed, orientation
+// are separate arrays, so that the per-frame loops (npc_step / npc_arrived,
+// the math of npc_actor::update_position and check_for_end_of_life) stream
+// through them. An NPC is a slot, not an actor: the prototype of its
+// species (an initialized npc_actor) gives mesh, skinning and scale, and the
+// species' baked swim cycle poses it at its own phase, in one instanced
+// draw per species and level of detail.
+// Slots of dead NPCs go to a free list that spawn() takes from; once
+// reserve() has run, spawn / respawn / kill and a single-threaded update
+// allocate nothing.
+// update() may split its loop over a thread_pool (whose parallel_for
+// allocates its jobs); everything else is for a single thread (publish and
+// draw: the OpenGL one).
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "cgp/cgp.hpp"
+#include "npc_actor.hpp"
+#include "baked_animation.hpp"
+
+struct thread_pool;
+
+struct npc_manager {
+    using handle = uint32_t;
+    static constexpr handle invalid = ~handle(0);
+
+    /* ---- one entry per slot, alive or not ------------------------------- */
+    std::vector<cgp::vec3> position;
+    std::vector<cgp::vec3> target;
+    std::vector<float>     speed;         ///< units per second
+    std::vector<cgp::vec4> orientation;   ///< unit quaternion (x, y, z, w), forward to the motion
+    std::vector<float>     phase;         ///< in the swim cycle (periods)
+    std::vector<float>     radius;        ///< bounding sphere about position, 0 if dead (hash_grid_broadphase)
+    std::vector<uint8_t>   species;
+    std::vector<uint8_t>   alive;
+
+    /// New species drawn as `prototype` (initialized, kept by pointer, posed by the bake),
+    /// whose model axis `forward` turns towards the motion (as align_to).
+    /// @return its index
+    int add_species(npc_actor& prototype, cgp::vec3 const& forward = { 0, 0, 1 });
+    int species_count() const { return int(kinds.size()); }
+
+    /// Room for `capacity` NPCs: no allocation below it
+    void   reserve(size_t capacity);
+    /// An NPC of `kind` at `origin`, swimming to `goal`: a free slot if there
+    /// is one, a new one otherwise
+    handle spawn(int kind, cgp::vec3 const& origin, cgp::vec3 const& goal, float swim_speed, float cycle_phase);
+    /// Same slot, new life
+    void   respawn(handle h, cgp::vec3 const& origin, cgp::vec3 const& goal, float swim_speed);
+    void   kill(handle h);
+    /// Kill everything (the slots stay allocated)
+    void   clear();
+    size_t size()     const { return live; }
+    size_t capacity() const { return alive.size(); }
+
+    /// Move every live NPC by `dt` towards its target and orient it; those
+    /// at their target end up in expired(). On the workers of `pool` and the
+    /// calling thread if given.
+    void update(float dt, thread_pool* pool = nullptr);
+    /// NPCs that reached their target in the last update (to respawn or kill)
+    std::vector<handle> const& expired() const { return arrived_list; }
+
+    /// Model matrix of the NPC in slot `h` (drawable.model of an actor)
+    cgp::mat4 model_matrix(handle h) const;
+
+    /// Bake the species' cycles if needed, pick each NPC's level and append
+    /// the instance tables of the frame (before the palette's upload); `t`:
+    /// animation time of the frame
+    void   publish(bone_palette& palette, cgp::mat4 const& view, cgp::mat4 const& projection,
+                   float lod_bias, float t);
+    /// One draw_instanced per species and level. @return the triangles drawn
+    size_t draw(cgp::environment_generic_structure const& environment, bool wireframe = false) const;
+    /// GL draws of draw(): one per submesh of each species and level of the last publish
+    size_t draw_calls() const;
+
+private:
+    struct kind_data {
+        npc_actor*                       prototype = nullptr;
+        cgp::vec3                        forward   = { 0, 0, 1 };
+        float                            radius    = 0;   ///< of the prototype's box, about its origin
+        std::unique_ptr<baked_animation> cycle;   ///< empty: drawn in the prototype's pose
+        std::vector<std::vector<handle>> at_level;   ///< of the last publish, reused
+    };
+    struct batch { int kind; int level; int table; int count; };
+
+    std::vector<kind_data> kinds;
+    std::vector<uint8_t>   level;          ///< per slot, for the hysteresis of lod_for_size
+    std::vector<uint8_t>   arrived;        ///< per slot, written by update's ranges
+    std::vector<handle>    free_slots;
+    std::vector<handle>    arrived_list;
+    std::vector<batch>     batches;
+    size_t                 live = 0;
+    float                  time = 0;       ///< of the last publish
+};
@@ -9,19 +9,19 @@ void shark_actor::initialize(cgp::opengl_shader_structure const& shader,
                 std::string const& texture_file) {
     // load glTF
     load_from_gltf(gltf_file, shader);
-    drawable.texture.load_and_initialize_texture_2d_on_gpu(
-        texture_file, GL_REPEAT, GL_REPEAT);
-    // define joint groups
-    groups = {
-        {"Tail",   {6,7,8,9,10}},
-        {"Body0",  {2}},
-        {"Body1",  {3,17,18,19}},
-        {"Body2",  {4,15,16}},
-        {"Body3",  {5,11,12,13,14}},
-        {"FinL",   {20,21,22}},
-        {"FinR",   {25,26,27}},
-        {"Jaw",    {29,30}}
-    };
+    load_texture(texture_file);
+    define_groups();
+}
+
+void shark_actor::define_groups() {
+    tail    = define_group("Tail",  {6,7,8,9,10});
+    body[0] = define_group("Body0", {2});
+    body[1] = define_group("Body1", {3,17,18,19});
+    body[2] = define_group("Body2", {4,15,16});
+    body[3] = define_group("Body3", {5,11,12,13,14});
+    fin_l   = define_group("FinL",  {20,21,22});
+    fin_r   = define_group("FinR",  {25,26,27});
+    jaw     = define_group("Jaw",   {29,30});
 }
 
 void shark_actor::start_position(skinned_actor const& target_actor) {
@@ -46,36 +46,45 @@ void shark_actor::start_position(skinned_actor const& target_actor) {
  * Generate wiggling animation on body, tail, fins and jaw.
  */
 void shark_actor::animate(float t) {
+    if (animate_clip(t)) return;   // authored clip playing
     // Body wave
     float w = 2*cgp::Pi*body_frequency;
-    std::array<std::string,4> seg = {"Body0","Body1","Body2","Body3"};
-    for (int i=0;i<seg.size();++i) {
-        float amp = body_amplitude * (amplitude_ratio + (1-amplitude_ratio)*(i/seg.size()));
+    for (int i=0;i<body.size();++i) {
+        float amp = body_amplitude * (amplitude_ratio + (1-amplitude_ratio)*(i/body.size()));
         float phase = w*t - i*body_lag;
-        rotate_group(seg[i], {0,0,1}, amp*std::sin(phase));
+        rotate_group(body[i], {0,0,1}, amp*std::sin(phase));
     }
 
-    size_t last = seg.size() - 1;           
+    size_t last = body.size() - 1;           
     // Tail
-    float amp_last   = body_amplitude * (amplitude_ratio + (1-amplitude_ratio)*(last/seg.size()));
+    float amp_last   = body_amplitude * (amplitude_ratio + (1-amplitude_ratio)*(last/body.size()));
     float phase_last = w*t - last*body_lag;
-    rotate_group("Tail", {0,0,1}, amp_last*std::sin(phase_last));
+    rotate_group(tail, {0,0,1}, amp_last*std::sin(phase_last));
     // Fins
     float fin = fin_amplitude * std::sin(w*t + cgp::Pi/2);
-    rotate_group("FinL",{0,1,0},  fin);
-    rotate_group("FinR",{0,1,0}, -fin);
+    rotate_group(fin_l,{0,1,0},  fin);
+    rotate_group(fin_r,{0,1,0}, -fin);
     // Jaw
-    float jaw = jaw_amplitude * std::max(0.f, std::sin(w*t));
-    rotate_group("Jaw",{1,0,0}, jaw);
-    upload_pose_to_gpu();
+    float jaw_angle = jaw_amplitude * std::max(0.f, std::sin(w*t));
+    rotate_group(jaw,{1,0,0}, jaw_angle);
+    evaluate_pose();
+}
+
+float shark_actor::animation_period() const
+{
+    if (clip_player.playing() || body_frequency <= 0) return 0.0f;
+    return 1.0f / body_frequency;
 }
 
 bool shark_actor::check_for_collision(skinned_actor  const& actor){
+    return shark_collision(drawable.model.matrix(), *res, actor.drawable.model.matrix(), *actor.res);
+}
+
+bool shark_collision(cgp::mat4 const& M1, ActorResources const& shark,
+                     cgp::mat4 const& M2, ActorResources const& other){
     // 1) Get shark‐local frame and world‐space centers of each actor’s bounding‐box center:
-    cgp::mat4 M1     = drawable.model.matrix();
-    cgp::vec3 C1     = (M1 * cgp::vec4(res->center_offset, 1)).xyz();
-    cgp::mat4 M2     = actor.drawable.model.matrix();
-    cgp::vec3 C2     = (M2 * cgp::vec4(actor.res->center_offset, 1)).xyz();
+    cgp::vec3 C1     = (M1 * cgp::vec4(shark.center_offset, 1)).xyz();
+    cgp::vec3 C2     = (M2 * cgp::vec4(other.center_offset, 1)).xyz();
 
     // 2) World‐space delta
     cgp::vec3 d_world = C2 - C1;
@@ -90,13 +99,13 @@ bool shark_actor::check_for_collision(skinned_actor  const& actor){
     //    shrinkXY lets you “cut off” fins, shrinkZ shortens the height if desired
     constexpr float shrinkXY = 0.7f;
     constexpr float shrinkZ  = 0.8f;
-    cgp::vec3   E1     = res->half_extents;               // (Ex, Ey, Ez)
+    cgp::vec3   E1     = shark.half_extents;               // (Ex, Ey, Ez)
     float  radius = std::max(E1.x, E1.y) * shrinkXY; // cylinder radius
     float  halfH  = E1.z * shrinkZ;                  // cylinder half‐height
 
     // 5) Box dimensions (other actor) in *shark‐local* axes:
     //    we’ll treat it as an AABB in this same frame
-    cgp::vec3   E2     = actor.res->half_extents;         
+    cgp::vec3   E2     = other.half_extents;         
 
     // 6) Horizontal (X–Y) distance from cylinder axis to box:
     //    if the box spans [–E2.x, +E2.x] in X, the closest X on the box to the axis is:
@@ -2,6 +2,13 @@
 #pragma once
 #include "npc_actor.hpp"
 #include "cgp/cgp.hpp"
+#include <array>
+
+/// check_for_collision of a shark posed by `M1` against another actor posed
+/// by `M2` (model matrices): the shark's cylinder vs the other's box.
+/// The narrowphase of the NPC broadphase too.
+bool shark_collision(cgp::mat4 const& M1, ActorResources const& shark,
+                     cgp::mat4 const& M2, ActorResources const& other);
 
 struct shark_actor final : public npc_actor {
     // ----- internal animation parameters -----
@@ -11,7 +18,10 @@ struct shark_actor final : public npc_actor {
     float        fin_amplitude     = 0.12f;     ///< fin beat amplitude
     float        body_lag          = 0.40f;     ///< phase lag along spine
     float amplitude_ratio = 0.5f;
+    std::array<group_handle, 4> body { -1, -1, -1, -1 };   ///< spine, head to tail
+    group_handle tail = -1, fin_l = -1, fin_r = -1, jaw = -1;
 
+    void define_groups() override;
     void initialize(cgp::opengl_shader_structure const& shader,
                     std::string const& gltf_file,
                     std::string const& texture_file) override;
@@ -21,6 +31,8 @@ struct shark_actor final : public npc_actor {
     bool check_for_collision(skinned_actor const&  actor) override;
 
     void animate(float t) override;
+    /// 1 / body_frequency: body, tail, fins and jaw follow the same wave
+    float animation_period() const override;
 
 private:
     /// Align the mesh forward (-Y) to given direction
@@ -0,0 +1,110 @@
+#include "shark_school.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+void shark_school::resize(int count, shark_actor const& prototype)
+{
+    count = std::max(count, 0);
+    static std::mt19937 engine{ 12345 };   // same school from run to run
+    std::uniform_real_distribution<float> radius(4.0f, 18.0f), speed(0.15f, 0.4f),
+                                          height(-0.5f, 3.0f), angle(0.0f, 2 * cgp::Pi);
+    while (size() < count) {
+        members.push_back(prototype);
+        orbit_radius.push_back(radius(engine));
+        orbit_speed.push_back(speed(engine) * (members.size() % 2 ? 1.0f : -1.0f));
+        orbit_height.push_back(height(engine));
+        phase.push_back(angle(engine));
+    }
+    members.resize(size_t(count), prototype);
+    orbit_radius.resize(size_t(count));
+    orbit_speed.resize(size_t(count));
+    orbit_height.resize(size_t(count));
+    phase.resize(size_t(count));
+}
+
+bool shark_school::baked_active() const
+{
+    return baked && cycle && cycle->ready() && !members.empty() && cycle->mode == members[0].skinning;
+}
+
+void shark_school::animate(float t, thread_pool* pool, animation_lod* lod)
+{
+    time = t;
+    bool const live = !baked_active();
+    // members only touch their own pose: any split of the school works
+    auto swim = [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; ++k) {
+            float const a = phase[k] + orbit_speed[k] * t;
+            float const r = orbit_radius[k];
+            float const s = orbit_speed[k] > 0 ? 1.0f : -1.0f;
+            shark_actor& m = members[k];
+            // swim from the orbit point towards the tangent: positioned and aligned
+            m.origin = center + cgp::vec3{ r * std::cos(a), r * std::sin(a), orbit_height[k] };
+            m.target = m.origin + cgp::vec3{ -s * std::sin(a), s * std::cos(a), 0.0f };
+            m.update_position(0.0f);
+            if (!live) continue;
+            if (lod) lod->animate(m, k, member_time(k, t));
+            else     m.animate(member_time(k, t));
+        }
+    };
+    if (pool)
+        pool->parallel_for(members.size(), swim, /*grain=*/16);
+    else
+        swim(0, members.size());
+}
+
+void shark_school::publish(bone_palette& palette, cgp::mat4 const& view, cgp::mat4 const& projection,
+                           float lod_bias)
+{
+    batches.clear();
+    if (members.empty() || members[0].res == nullptr) return;
+
+    if (baked && !baked_active() && members[0].animation_period() > 0) {
+        if (!cycle) cycle = std::make_unique<baked_animation>();
+        cycle->bake(members[0], baked_frames, members[0].skinning);
+    }
+    drawn_baked = baked_active();   // else the live poses of animate()
+
+    for (std::vector<int>& at : members_at) at.clear();
+    members_at.resize(std::max(members_at.size(), members[0].res->lods.size()));
+    for (size_t k = 0; k < members.size(); ++k) {
+        shark_actor& m = members[k];
+        m.select_lod(view, projection, lod_bias);
+        if (!drawn_baked) m.publish_pose(palette);
+        members_at[size_t(m.lod)].push_back(int(k));
+    }
+    // the records of a level are consecutive: its instance table
+    for (size_t lod = 0; lod < members_at.size(); ++lod) {
+        if (members_at[lod].empty()) continue;
+        int table = -1;
+        for (int k : members_at[lod]) {
+            shark_actor const& m = members[size_t(k)];
+            int const record = drawn_baked
+                ? palette.add_instance(m.drawable.model.matrix(), 0, cycle->phase_at(member_time(size_t(k), 0.0f)))
+                : palette.add_instance(m.drawable.model.matrix(), m.bone_offset);
+            if (table < 0) table = record;
+        }
+        batches.push_back({ table, int(members_at[lod].size()), int(lod) });
+    }
+}
+
+size_t shark_school::draw(cgp::environment_generic_structure const& environment, bool wireframe) const
+{
+    size_t triangles = 0;
+    for (batch const& b : batches) {
+        shark_actor const& first = members[size_t(members_at[size_t(b.lod)][0])];
+        triangles += first.draw_instanced(environment, b.table, b.count, wireframe,
+                                          drawn_baked ? cycle.get() : nullptr, time);
+    }
+    return triangles;
+}
+
+size_t shark_school::draw_calls() const
+{
+    size_t calls = 0;
+    for (batch const& b : batches)
+        calls += members[size_t(members_at[size_t(b.lod)][0])].draw_calls(b.lod);
+    return calls;
+}
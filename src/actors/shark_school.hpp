@@ -0,0 +1,57 @@
+#pragma once
+// shark_school.hpp
+// Crowd of decorative sharks circling the scene. Every member shares the
+// ActorResources of the gameplay shark it was copied from; each frame they
+// get their own pose in the bone_palette, then one instanced draw per level
+// of detail draws all the members at that level.
+// With `baked`, the swim cycle is sampled once into a baked_animation and the
+// members only move along their orbits: the shader poses each one at its own
+// phase of the cycle (no animate(), no palette space). Live evaluation is the
+// fallback when the cycle cannot be baked (clip playing, not periodic).
+
+#include <memory>
+#include <vector>
+#include "shark_actor.hpp"
+#include "baked_animation.hpp"
+#include "../utils/thread_pool.hpp"
+
+struct shark_school {
+    std::vector<shark_actor> members;
+    // orbit of each member around `center` (SoA)
+    std::vector<float> orbit_radius, orbit_speed, orbit_height, phase;
+    cgp::vec3 center = { 0, 0, 0 };
+    bool baked        = true;   ///< pose the members with `cycle` when it can be baked
+    int  baked_frames = 96;     ///< poses in one period of the cycle
+    std::unique_ptr<baked_animation> cycle;   ///< baked at the first publish (OpenGL thread)
+
+    /// `count` members copied from `prototype` (an initialized shark_actor);
+    /// the current members are kept when growing
+    void resize(int count, shark_actor const& prototype);
+    int  size() const { return int(members.size()); }
+
+    /// Swim along the orbits and animate, each member with its own phase;
+    /// on the workers of `pool` and the calling thread if given, at the
+    /// update rate `lod` gives each member if given (orbits only when baked)
+    void animate(float t, thread_pool* pool = nullptr, animation_lod* lod = nullptr);
+    /// The members are posed by `cycle` (baked, and baked in their skinning mode)
+    bool baked_active() const;
+
+    /// Poses and instance tables of the frame, one table per level (before
+    /// the palette's upload); bakes `cycle` first if it is missing or stale
+    void publish(bone_palette& palette, cgp::mat4 const& view, cgp::mat4 const& projection,
+                 float lod_bias);
+    /// One draw_instanced per level. @return the triangles drawn
+    size_t draw(cgp::environment_generic_structure const& environment, bool wireframe = false) const;
+    /// GL draws of draw(): one per submesh of each level of the last publish
+    size_t draw_calls() const;
+
+private:
+    struct batch { int table; int count; int lod; };
+    std::vector<batch>            batches;        ///< of the last publish
+    std::vector<std::vector<int>> members_at;     ///< per level, reused from frame to frame
+    float                         time = 0;       ///< of the last animate
+    bool                          drawn_baked = false;   ///< the last publish used `cycle`
+
+    /// Animation time of member k: out of step with each other
+    float member_time(size_t k, float t) const { return t + phase[k] * 10.0f; }
+};
@@ -0,0 +1,110 @@
+#include "skeleton.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool skeleton::build(std::vector<int> const& joint_parent, std::vector<gltf_joint_rest> const& rest,
+                     cgp::mat4 const& skeleton_base)
+{
+    *this = skeleton();
+    int const n = int(joint_parent.size());
+    if (rest.size() != joint_parent.size()) return false;
+
+    // depth of each joint; a chain longer than the skeleton is a cycle
+    std::vector<int> depth(size_t(n), -1);
+    for (int j = 0; j < n; ++j) {
+        int d = 0;
+        for (int a = joint_parent[size_t(j)]; a >= 0; a = joint_parent[size_t(a)]) {
+            if (a >= n || ++d > n) {
+                std::cerr << "[skeleton] invalid parent chain at joint " << j << std::endl;
+                return false;
+            }
+        }
+        depth[size_t(j)] = d;
+    }
+
+    order.resize(size_t(n));
+    for (int j = 0; j < n; ++j) order[size_t(j)] = j;
+    std::stable_sort(order.begin(), order.end(),
+                     [&depth](int a, int b) { return depth[size_t(a)] < depth[size_t(b)]; });
+
+    parent = joint_parent;
+    translation.reserve(size_t(n));
+    rotation.reserve(size_t(n));
+    scale.reserve(size_t(n));
+    for (gltf_joint_rest const& r : rest) {
+        translation.push_back(r.translation);
+        rotation.push_back(r.rotation);
+        scale.push_back(r.scale);
+    }
+    base = skeleton_base;
+    return true;
+}
+
+bool skeleton::in_subtree(int joint, int ancestor) const
+{
+    for (int a = joint; a >= 0; a = parent[size_t(a)])
+        if (a == ancestor) return true;
+    return false;
+}
+
+
+cgp::vec4 quaternion_axis_angle(cgp::vec3 const& axis, float angle)
+{
+    float const n = std::sqrt(axis.x*axis.x + axis.y*axis.y + axis.z*axis.z);
+    if (n == 0) return { 0, 0, 0, 1 };
+    float const s = std::sin(0.5f * angle) / n;
+    return { axis.x * s, axis.y * s, axis.z * s, std::cos(0.5f * angle) };
+}
+
+cgp::vec4 quaternion_product(cgp::vec4 const& a, cgp::vec4 const& b)
+{
+    return { a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+             a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
+             a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w,
+             a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z };
+}
+
+
+void skeleton_pose::reset(skeleton const& s)
+{
+    translation = s.translation;
+    rotation    = s.rotation;
+    scale       = s.scale;
+    model.resize(s.size());
+    dirty.assign(s.size(), 1);
+}
+
+void skeleton_pose::rest(skeleton const& s)
+{
+    if (rotation.size() != s.size()) {
+        reset(s);
+        return;
+    }
+    for (size_t j = 0; j < s.size(); ++j) {
+        set_translation(int(j), s.translation[j]);
+        set_rotation(int(j), s.rotation[j]);
+        set_scale(int(j), s.scale[j]);
+    }
+}
+
+size_t skeleton_pose::evaluate(skeleton const& s, std::vector<cgp::mat4> const& inverse_bind,
+                               std::vector<cgp::mat4>& skin)
+{
+    if (rotation.size() != s.size()) reset(s);
+    size_t recomputed = 0;
+    for (int j : s.order) {
+        int const p = s.parent[size_t(j)];
+        if (p >= 0 && dirty[size_t(p)]) dirty[size_t(j)] = 1;   // parents come first
+        if (!dirty[size_t(j)]) continue;
+
+        cgp::mat4 const local = gltf_trs_matrix(translation[size_t(j)], rotation[size_t(j)], scale[size_t(j)]);
+        model[size_t(j)] = (p >= 0 ? model[size_t(p)] : s.base) * local;
+        if (size_t(j) < skin.size() && size_t(j) < inverse_bind.size())
+            skin[size_t(j)] = model[size_t(j)] * inverse_bind[size_t(j)];
+        ++recomputed;
+    }
+    std::fill(dirty.begin(), dirty.end(), 0);
+    return recomputed;
+}
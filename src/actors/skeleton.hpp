@@ -0,0 +1,78 @@
+#pragma once
+// skeleton.hpp
+// Joint hierarchy of a skinned mesh and its pose evaluation.
+//   - skeleton: the rest pose, shared by every actor of a species (parent of
+//     each joint, local rest TRS, joints sorted parents first)
+//   - skeleton_pose: the local joint TRS of one actor; evaluate() walks the
+//     sorted joints once, local TRS -> model -> skinning matrix, and only
+//     recomputes the subtrees under a joint whose transform changed
+// Flat arrays indexed by joint, in the glTF skin order (that of JOINTS_0).
+// No allocation after the first evaluate().
+
+#include <vector>
+#include "cgp/cgp.hpp"
+#include "../loader/gltf_loader.hpp"
+
+struct skeleton {
+    std::vector<int>       parent;        ///< |J| parent joint, -1 for the roots
+    std::vector<int>       order;         ///< |J| joints, every parent before its children
+    std::vector<cgp::vec3> translation;   ///< |J| local rest transform
+    std::vector<cgp::vec4> rotation;      ///< |J| quaternion (x, y, z, w)
+    std::vector<cgp::vec3> scale;         ///< |J|
+    cgp::mat4              base = cgp::mat4::build_identity();   ///< transform above the roots
+
+    /// From the loader's output (gltf_geometry_and_texture::joint_parent,
+    /// joint_rest, skeleton_base). Returns false, and stays empty, if the
+    /// parents do not form a forest.
+    bool build(std::vector<int> const& joint_parent, std::vector<gltf_joint_rest> const& rest,
+               cgp::mat4 const& skeleton_base);
+
+    size_t size() const { return parent.size(); }
+    /// True if `ancestor` is `joint` or one of its ancestors
+    bool in_subtree(int joint, int ancestor) const;
+};
+
+/// Rotation of `angle` radians about `axis`, as a quaternion (x, y, z, w)
+cgp::vec4 quaternion_axis_angle(cgp::vec3 const& axis, float angle);
+/// a then b: the quaternion of the rotation matrix R(a) R(b)
+cgp::vec4 quaternion_product(cgp::vec4 const& a, cgp::vec4 const& b);
+
+struct skeleton_pose {
+    std::vector<cgp::vec3>     translation;   ///< |J| local transform (the rest one until set)
+    std::vector<cgp::vec4>     rotation;      ///< |J|
+    std::vector<cgp::vec3>     scale;         ///< |J|
+    std::vector<cgp::mat4>     model;         ///< |J| joint -> mesh space, valid after evaluate()
+    std::vector<unsigned char> dirty;         ///< |J| transform changed since the last evaluate()
+
+    /// Rest pose, every joint to recompute
+    void reset(skeleton const& s);
+    /// Back to the rest transforms: only the joints that moved are recomputed
+    void rest(skeleton const& s);
+    void set_rotation(int joint, cgp::vec4 const& q)
+    {
+        cgp::vec4& r = rotation[size_t(joint)];
+        if (r.x == q.x && r.y == q.y && r.z == q.z && r.w == q.w) return;
+        r = q;
+        dirty[size_t(joint)] = 1;
+    }
+    void set_translation(int joint, cgp::vec3 const& t)
+    {
+        cgp::vec3& p = translation[size_t(joint)];
+        if (p.x == t.x && p.y == t.y && p.z == t.z) return;
+        p = t;
+        dirty[size_t(joint)] = 1;
+    }
+    void set_scale(int joint, cgp::vec3 const& k)
+    {
+        cgp::vec3& p = scale[size_t(joint)];
+        if (p.x == k.x && p.y == k.y && p.z == k.z) return;
+        p = k;
+        dirty[size_t(joint)] = 1;
+    }
+
+    /// One pass over s.order: the model matrix of every dirty joint and of
+    /// its descendants, and skin[j] = model[j] * inverse_bind[j].
+    /// @return the number of joints recomputed
+    size_t evaluate(skeleton const& s, std::vector<cgp::mat4> const& inverse_bind,
+                    std::vector<cgp::mat4>& skin);
+};
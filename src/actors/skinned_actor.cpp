@@ -1,13 +1,30 @@
 #include "skinned_actor.hpp"
 #include "cgp/cgp.hpp"
+#include "../loader/mesh_cache.hpp"
+#include "../utils/timing.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 
-// Static cache
-static std::unordered_map<std::string,
-    std::shared_ptr<ActorResources>> resource_cache;
+/// resources() key of a glTF mesh: its prototype is bound to a shader
+static std::string mesh_key(const std::string& file, const cgp::opengl_shader_structure& shader)
+{
+    return resource_manager::make_key(resource_kind::mesh, file,
+                                      "shader=" + std::to_string(shader.id));
+}
 
 //-----------------------------------------------------------------------------
 // ActorResources
 //-----------------------------------------------------------------------------
+ActorResources::~ActorResources()
+{
+    if (gpu.vao == 0 || !gl_context_alive()) return;
+
+    GLuint const buffers[] = { gpu.vertices, gpu.indices };
+    glDeleteBuffers(2, buffers);
+    glDeleteVertexArrays(1, &gpu.vao);
+}
+
 void ActorResources::compute_radius() {
     cgp::vec3 pmin, pmax;
     geometry.get_bounding_box_position(pmin, pmax);
@@ -30,80 +47,331 @@ void ActorResources::compute_bounding_box()
 //-----------------------------------------------------------------------------
 // skinned_actor
 //-----------------------------------------------------------------------------
-void skinned_actor::rotate_group(std::string_view group_name,
-    cgp::vec3 axis, float angle_rad)
+skinned_actor::group_handle skinned_actor::define_group(std::string_view name,
+    std::initializer_list<int> joints)
+{
+    if (group_handle g = find_group(name); g >= 0)
+        return g;
+    bool const hierarchy = res != nullptr && res->skel.size() == uBones.size();
+    for (int j : joints) {
+        if (j < 0 || j >= int(uBones.size())) continue;
+        bool nested = false;                 // under another joint of the group: follows it
+        for (int a : joints)
+            nested = nested || (hierarchy && a != j && res->skel.in_subtree(j, a));
+        if (!nested) group_joints.push_back(j);
+    }
+    group_names.emplace_back(name);
+    group_first.push_back(int(group_joints.size()));
+    return group_handle(group_names.size() - 1);
+}
+
+
+skinned_actor::group_handle skinned_actor::find_group(std::string_view name) const
+{
+    auto it = std::find(group_names.begin(), group_names.end(), name);
+    return it == group_names.end() ? -1 : group_handle(it - group_names.begin());
+}
+
+
+void skinned_actor::rotate_group(group_handle g, cgp::vec3 axis, float angle_rad)
 {
-    auto it = groups.find(std::string(group_name));
-    if (it == groups.end()) return;              // unknown group → no-op
-    for (int j : it->second)                     // all joints in group
+    if (g < 0 || g >= int(group_names.size())) return;   // unknown group → no-op
+    if (pose.rotation.size() != res->skel.size()) pose.reset(res->skel);
+    cgp::vec4 const q = quaternion_axis_angle(axis, angle_rad);
+    for (int k = group_first[g]; k < group_first[g + 1]; ++k)   // all joints in group
     {
-        cgp::mat4 bind = inverse( res->inverse_bind[j] );  // rest-pose
-        cgp::mat4 R = cgp::affine_rt(
-                cgp::rotation_transform::
-                    from_axis_angle(axis, angle_rad),
-                {0,0,0}).matrix();
-        uBones[j] = bind * R * res->inverse_bind[j];
+        int const j = group_joints[k];
+        pose.set_rotation(j, quaternion_product(res->skel.rotation[j], q));
     }
 }
 
 
-void skinned_actor::upload_pose_to_gpu() const
+bool skinned_actor::play_clip(int clip, float t)
+{
+    if (res == nullptr) return false;
+    pose.rest(res->skel);   // no procedural rotation left on the joints the clip does not animate
+    clip_player.play(res->animations, clip, t);
+    return clip_player.playing();
+}
+
+bool skinned_actor::play_clip(std::string_view name, float t)
+{
+    return res != nullptr && play_clip(res->animations.find(name), t);
+}
+
+void skinned_actor::stop_clip()
+{
+    clip_player.stop();
+    if (res != nullptr)
+        pose.rest(res->skel);   // nor the translations and scales the clip wrote
+}
+
+bool skinned_actor::animate_clip(float t)
+{
+    if (res == nullptr || !clip_player.playing()) return false;
+    if (pose.rotation.size() != res->skel.size()) pose.reset(res->skel);
+    clip_player.sample(res->animations, t, pose);
+    evaluate_pose();
+    return true;
+}
+
+
+size_t skinned_actor::evaluate_pose()
+{
+    if (res == nullptr) return 0;
+    joints_evaluated = pose.evaluate(res->skel, res->inverse_bind, uBones);
+    return joints_evaluated;
+}
+
+
+void skinned_actor::publish_pose(bone_palette& palette)
+{
+    bone_offset = palette.add(uBones.data(), uBones.size(), skinning);
+}
+
+
+void skinned_actor::set_skinning(skinning_mode mode, cgp::opengl_shader_structure const& shader)
+{
+    skinning         = mode;
+    drawable.shader  = shader;
+    palette_location = glGetUniformLocation(shader.id, "uBonePalette");
+    offset_location  = glGetUniformLocation(shader.id, "uBoneOffset");
+    instance_location = glGetUniformLocation(shader.id, "uInstanceTable");
+    baked_location        = glGetUniformLocation(shader.id, "uBakedAnimation");
+    baked_frames_location = glGetUniformLocation(shader.id, "uBakedFrames");
+    baked_stride_location = glGetUniformLocation(shader.id, "uBakedStride");
+    baked_time_location   = glGetUniformLocation(shader.id, "uBakedTime");
+}
+
+
+float skinned_actor::projected_size(cgp::mat4 const& view, cgp::mat4 const& projection, float* distance) const
+{
+    cgp::vec3 const c = res->center_offset;
+    cgp::vec4 const center = view * (drawable.model.matrix() * cgp::vec4{ c.x, c.y, c.z, 1.0f });
+    cgp::vec3 const s = drawable.model.scaling_xyz;
+    float const radius = res->radius * drawable.model.scaling * std::max({ s.x, s.y, s.z });
+    float const depth  = -center.z;                       // the camera looks down -z
+    if (distance) *distance = norm(center.xyz());
+    return depth > 1e-3f ? radius * projection(1, 1) / depth : 0.0f;
+}
+
+void skinned_actor::select_lod(cgp::mat4 const& view, cgp::mat4 const& projection, float bias)
+{
+    if (res == nullptr) return;
+    lod = lod_for_size(bias * projected_size(view, projection), lod, int(res->lods.size()));
+}
+
+int skinned_actor::lod_for_size(float size, int current, int lod_count)
+{
+    int const coarsest = std::min(lod_count - 1, int(std::size(lod_screen_size)));
+    int lod = std::clamp(current, 0, std::max(coarsest, 0));
+    while (lod < coarsest && size < lod_screen_size[lod] * (1.0f - lod_hysteresis))
+        ++lod;
+    while (lod > 0 && size > lod_screen_size[lod - 1] * (1.0f + lod_hysteresis))
+        --lod;
+    return lod;
+}
+
+
+size_t skinned_actor::draw(cgp::environment_generic_structure const& environment, bool wireframe) const
+{
+    return draw_instanced(environment, -1, 1, wireframe);
+}
+
+
+size_t skinned_actor::draw_calls(int level) const
 {
-    glUseProgram(drawable.shader.id);
-    for (size_t j = 0; j < uBones.size(); ++j) {
-        std::string name = "uBones[" + std::to_string(j) + "]";
-        GLint loc = glGetUniformLocation(drawable.shader.id, name.c_str());
-        if (loc >= 0)
-            glUniformMatrix4fv(loc, 1, GL_FALSE, &uBones[j](0,0));
+    if (res == nullptr || drawable.vao == 0 || res->lods.empty()) return 0;
+    level = std::clamp(level < 0 ? lod : level, 0, int(res->lods.size()) - 1);
+    return res->lods[size_t(level)].size();
+}
+
+size_t skinned_actor::draw_instanced(cgp::environment_generic_structure const& environment,
+                                     int instance_table, int instances, bool wireframe,
+                                     baked_animation const* baked, float t, int level) const
+{
+    if (res == nullptr || drawable.vao == 0 || instances <= 0) return 0;
+    level = std::clamp(level < 0 ? lod : level, 0, int(res->lods.size()) - 1);
+    std::vector<gltf_submesh> const& submeshes = res->lods[size_t(level)];
+    cgp::opengl_shader_structure const& shader = drawable.shader;
+
+    glUseProgram(shader.id);
+    if (offset_location >= 0) {
+        glUniform1i(palette_location, bone_palette_unit);
+        glUniform1i(offset_location, bone_offset);
+    }
+    if (instance_location >= 0)
+        glUniform1i(instance_location, instance_table);
+    if (baked_location >= 0)   // its own unit even when unused: not image_texture's sampler2D one
+        glUniform1i(baked_location, baked_animation_unit);
+    if (baked_frames_location >= 0) {
+        bool const use_baked = baked && baked->ready() && baked->mode == skinning;
+        glUniform1i(baked_frames_location, use_baked ? baked->frames : 0);
+        if (use_baked) {
+            baked->bind(baked_animation_unit);
+            glUniform1i(baked_stride_location, baked->stride());
+            glUniform1f(baked_time_location, baked->phase_at(t));
+        }
+    }
+    drawable.send_opengl_uniform(false);
+    environment.send_opengl_uniform(shader, false);
+
+    glActiveTexture(GL_TEXTURE0);
+    cgp::opengl_uniform(shader, "image_texture", 0, false);
+    cgp::opengl_uniform(shader, "uPositionOffset", res->position_offset, false);
+    cgp::opengl_uniform(shader, "uPositionScale",  res->position_scale,  false);
+
+    if (wireframe) {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        glEnable(GL_POLYGON_OFFSET_LINE);
+        glPolygonOffset(-1.0f, -1.0f);
+        cgp::opengl_uniform(shader, "material.texture_settings.use_texture", false, false);
+    }
+
+    glBindVertexArray(drawable.vao);   // the EBO is part of the VAO state
+    size_t triangles = 0;
+    for (size_t k = 0; k < submeshes.size(); ++k)
+    {
+        gltf_submesh const& sub = submeshes[k];
+
+        auto tex = res->textures.find(sub.image);
+        if (k == 0 || tex == res->textures.end())
+            drawable.texture.bind();
+        else
+            tex->second->texture.bind();
+
+        if (wireframe)
+            cgp::opengl_uniform(shader, "material.color", cgp::vec3{ 0, 0, 1 }, false);
+        else {
+            cgp::opengl_uniform(shader, "material.color", drawable.material.color * cgp::vec3{ sub.base_color.x, sub.base_color.y, sub.base_color.z }, false);
+            cgp::opengl_uniform(shader, "material.alpha", drawable.material.alpha * sub.base_color.w, false);
+        }
+
+        void const* first = reinterpret_cast<void*>(size_t(sub.first_triangle) * 3 * size_t(res->gpu.format.size));
+        if (instance_table < 0)
+            glDrawElements(GL_TRIANGLES, GLsizei(3 * sub.triangle_count), res->gpu.format.type, first);
+        else
+            glDrawElementsInstanced(GL_TRIANGLES, GLsizei(3 * sub.triangle_count), res->gpu.format.type,
+                                    first, GLsizei(instances));
+        triangles += sub.triangle_count * size_t(instances);
+    }
+    glBindVertexArray(0);
+    if (wireframe) {
+        glDisable(GL_POLYGON_OFFSET_LINE);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
+    glBindTexture(GL_TEXTURE_2D, 0);
     glUseProgram(0);
+    return triangles;
 }
 
 
-void skinned_actor::load_from_gltf(const std::string& file,
+gltf_geometry_and_texture skinned_actor::decode_gltf(const std::string& file)
+{
+    // from the baked cache when it is up to date
+    auto t0 = std::chrono::steady_clock::now();
+    gltf_geometry_and_texture data;
+    bool from_cache = mesh_cache_load(file, data);
+    if (!from_cache)
+        data = mesh_load_file_gltf(file, /*load_texture=*/false);
+    double ms = elapsed_ms(t0);
+    std::cout << "[skinned_actor] " << file
+              << (from_cache ? " (mesh cache) " : " (glTF) ")
+              << ms << " ms" << std::endl;
+    return data;
+}
+
+
+/// Upload decoded glTF data and register it under `key` (GL thread)
+static std::shared_ptr<ActorResources> upload_gltf(const std::string& key,
+    const std::string& file,
+    gltf_geometry_and_texture&& data,
     const cgp::opengl_shader_structure& shader)
 {
-   // Lookup or fill the cache
-    auto it = resource_cache.find(file);
-    if(it == resource_cache.end()) {
-        // load glTF once
-        gltf_geometry_and_texture data = mesh_load_file_gltf(file);
-
-        auto R = std::make_shared<ActorResources>();
-        R->geometry      = data.geom;  
-        R->inverse_bind  = std::move(data.inverse_bind);
-        R->joint_node    = std::move(data.joint_node);
-        R->joint_index   = data.joint_index;
-        R->joint_weight  = data.joint_weight;
-
-        // Build prototype drawable
-        R->prototype.initialize_data_on_gpu(
-          data.geom, shader, data.tex);
-        add_skin_attributes(
-          R->prototype,
-          R->joint_index, R->joint_weight);
-
-        R->compute_radius();
-        R->compute_bounding_box();
-
-        resource_cache[file] = R;
-        res = R;
-    }
-    else {
-        res = it->second;
+    gltf_upload_textures(data, file);
+
+    // the cache holds no texture: fall back to CGP's white one
+    if (data.tex.id == 0)
+        data.tex = cgp::mesh_drawable::default_texture;
+
+    auto R = std::make_shared<ActorResources>();
+    R->geometry      = data.geom;  
+    R->inverse_bind  = std::move(data.inverse_bind);
+    if (!R->skel.build(data.joint_parent, data.joint_rest, data.skeleton_base) && !data.joint_parent.empty())
+        std::cerr << "[skinned_actor] " << file << ": no joint hierarchy, rest pose only" << std::endl;
+    R->joint_node    = std::move(data.joint_node);
+    R->animations    = std::move(data.animations);
+    R->joint_index   = data.joint_index;
+    R->joint_weight  = data.joint_weight;
+    R->lods.push_back(std::move(data.submeshes));
+    for (size_t k = 0; !R->lods[0].empty() && k < data.lod_submeshes.size(); k += R->lods[0].size())
+        R->lods.emplace_back(data.lod_submeshes.begin() + k, data.lod_submeshes.begin() + k + R->lods[0].size());
+    for (auto const& level : R->lods) {
+        size_t n = 0;
+        for (gltf_submesh const& sub : level) n += sub.triangle_count;
+        R->lod_triangles.push_back(n);
     }
+    R->textures      = std::move(data.textures);
+
+    // Build prototype drawable: packed interleaved vertices in our own VAO
+    packed_skin_mesh const packed = pack_skin_vertices(data.geom, data.joint_index, data.joint_weight);
+    R->gpu             = upload_packed_skin_mesh(packed, data.geom.connectivity);
+    R->position_offset = packed.position_offset;
+    R->position_scale  = packed.position_scale;
+    R->prototype.shader  = shader;
+    R->prototype.texture = data.tex;
+    R->prototype.vao     = R->gpu.vao;
+
+    R->gpu_bytes = packed.vertices.size() * sizeof(packed_skin_vertex)
+                 + data.geom.connectivity.size() * 3 * size_t(R->gpu.format.size);
+
+    R->compute_radius();
+    R->compute_bounding_box();
+
+    return resources().insert(key, R);
+}
+
+
+std::shared_ptr<ActorResources> skinned_actor::preload_gltf(const std::string& file,
+    gltf_geometry_and_texture&& data,
+    const cgp::opengl_shader_structure& shader)
+{
+    std::string const key = mesh_key(file, shader);
+    if (auto R = resources().find<ActorResources>(key))
+        return R;
+    return upload_gltf(key, file, std::move(data), shader);
+}
+
+
+void skinned_actor::load_from_gltf(const std::string& file,
+    const cgp::opengl_shader_structure& shader)
+{
+    // Shared with every actor loaded from the same file (and shader)
+    std::string const key = mesh_key(file, shader);
+    res = resources().find<ActorResources>(key);
+    if (res == nullptr)
+        res = upload_gltf(key, file, decode_gltf(file), shader);
 
     // Actor‐local initialization
-    uBones.resize(res->inverse_bind.size());
-    reset_pose();
+    uBones.assign(res->inverse_bind.size(), cgp::mat4::build_identity());
+    pose.reset(res->skel);
+    evaluate_pose();
 
     // copy the shared VAO/VBO into our own drawable
     drawable = res->prototype;  // shallow copy of handles is fine
+    set_skinning(skinning_mode::matrix, shader);
+}
+
+
+void skinned_actor::load_texture(const std::string& file)
+{
+    texture_res      = resources().texture(file, GL_REPEAT);
+    drawable.texture = texture_res->texture;
 }
 
 
 void skinned_actor::reset_pose()
 {
-    for (auto& M : uBones)
-        M = cgp::mat4(1.0f);   // CGP/GLM identity constructor
+    if (res != nullptr)
+        pose.rest(res->skel);
 }
\ No newline at end of file
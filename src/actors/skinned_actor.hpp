@@ -2,7 +2,14 @@
 #include "cgp/cgp.hpp"
 #include "../loader/gltf_loader.hpp"
 #include "../loader/gpu_skin_helper.hpp"
-#include <unordered_map>
+#include "../loader/bone_palette.hpp"
+#include "../loader/resource_manager.hpp"
+#include "skeleton.hpp"
+#include "animation_player.hpp"
+#include "animation_lod.hpp"
+#include "baked_animation.hpp"
+#include <initializer_list>
+#include <map>
 #include <vector>
 #include <string_view>
 
@@ -10,13 +17,30 @@
 
 
 
+/// Mesh shared by every actor of a species, owned through the resource
+/// manager: its GL buffers are deleted with the last actor using it.
 struct ActorResources {
+    static constexpr resource_kind kind = resource_kind::mesh;
+
+    ActorResources() = default;
+    ActorResources(ActorResources const&)            = delete;
+    ActorResources& operator=(ActorResources const&) = delete;
+    ~ActorResources();
+
     /*=============== raw skin data straight from glTF ===============*/
     std::vector<cgp::mat4> inverse_bind;   ///< |J| inverse-bind matrices
     std::vector<int> joint_node;     ///< |J| skin->node map
+    skeleton         skel;           ///< joint hierarchy and rest pose
+    gltf_animation_set animations;   ///< authored clips (may be empty)
     
 
-    cgp::mesh_drawable prototype;       ///< the mesh we actually draw
+    cgp::mesh_drawable prototype;       ///< shader, texture and vao (= gpu.vao) of the mesh we draw
+    std::vector<std::vector<gltf_submesh>> lods; ///< draw ranges in the EBO per level, [0] = full mesh
+    std::vector<size_t>        lod_triangles; ///< triangle count per level
+    std::map<int, std::shared_ptr<texture_resource>> textures; ///< glTF image → texture
+    skin_buffers               gpu;          ///< packed vertices + indices (16-bit when possible)
+    cgp::vec3                  position_offset, position_scale; ///< dequantization (uPosition*)
+    size_t                     gpu_bytes = 0; ///< vertex + index buffers
     cgp::numarray<cgp::uint4>        joint_index;
     cgp::numarray<cgp::vec4>         joint_weight;
     // Collision mechanism
@@ -35,20 +59,95 @@ struct skinned_actor
 {
     virtual ~skinned_actor() = default;
     std::vector<cgp::mat4> uBones;         ///< |J| final pose (shader)
+    skeleton_pose          pose;           ///< local joint rotations, see evaluate_pose
+    animation_player       clip_player;    ///< authored clip overriding animate()'s procedural one
+    animation_lod_state    anim_lod;       ///< update rate, see animation_lod
+    int                    bone_offset = 0;   ///< of uBones in the frame's bone_palette (texels)
+    skinning_mode          skinning    = skinning_mode::matrix;   ///< layout of drawable.shader's bones
+    size_t                 joints_evaluated = 0;   ///< by the last evaluate_pose()
     std::shared_ptr<ActorResources> res;   // shared data
+    std::shared_ptr<texture_resource> texture_res;   ///< keeps drawable.texture alive
     cgp::mesh_drawable     drawable;       ///< the mesh we actually draw
+    int                    lod = 0;        ///< level drawn (res->lods), see select_lod
+
+    /// Projected height (fraction of the half screen) below which LOD k+1 is used
+    static constexpr float lod_screen_size[3] = { 0.25f, 0.12f, 0.06f };
+    /// Relative margin around each threshold, so that the level does not flicker
+    static constexpr float lod_hysteresis     = 0.2f;
 
     /*=============== high-level helpers =============================*/
-    /// a named set of joints, e.g. "Tail", "Mouth", "RF" (right-front fin) …
-    using joint_group = std::vector<int>;
-    std::unordered_map<std::string, joint_group> groups;
+    /// Index of a named set of joints, e.g. "Tail", "Mouth", "RF" (right-front fin) …
+    /// Resolved once (define_group / find_group), -1 if unknown.
+    using group_handle = int;
+    /// Flat joint table: group g owns group_joints[group_first[g] .. group_first[g+1])
+    std::vector<std::string> group_names;
+    std::vector<int>         group_first { 0 };
+    std::vector<int>         group_joints;
+
+    /// Add the group `name` (joints outside the skeleton are dropped, and so
+    /// are those under another joint of the group: they follow it);
+    /// returns the existing handle if it is already defined.
+    group_handle define_group(std::string_view name, std::initializer_list<int> joints);
+    group_handle find_group(std::string_view name) const;
+
+    /// Rotate the joints of group `g` *about `axis`* (their local frame) from
+    /// their rest rotation; their subtrees follow at the next evaluate_pose().
+    void rotate_group(group_handle g, cgp::vec3 axis, float angle_rad);
+
+    /// Play clip `clip` of res->animations from time `t`, looping, from the
+    /// rest pose; false, and nothing playing, if the asset has no such clip
+    bool play_clip(int clip, float t);
+    /// Same, the first clip named `name`
+    bool play_clip(std::string_view name, float t);
+    /// Back to the procedural animation, from the rest pose
+    void stop_clip();
+    /// Pose of the playing clip at time `t`, evaluated (start of animate());
+    /// false if no clip is playing
+    bool animate_clip(float t);
 
-    /// Apply a rotation *about `axis`* to **all** joints in `group_name`.
-    void rotate_group(std::string_view group_name,
-                      cgp::vec3 axis, float angle_rad);
+    /// uBones of the joints moved since the last call, and of their subtrees
+    /// (end of animate()). @return the number of joints recomputed
+    size_t evaluate_pose();
 
-    /// Tell OpenGL the current pose (call once per frame *before* draw()).
-    void upload_pose_to_gpu() const;
+    /// Texture unit of the bone_palette read by the skinning shader
+    static constexpr int bone_palette_unit = 2;
+    /// Texture unit of the baked_animation of an instanced draw
+    static constexpr int baked_animation_unit = 3;
+    /// Append the current pose to the frame's palette (before its upload)
+    void publish_pose(bone_palette& palette);
+    /// Draw with `shader`, the turtle.vert.glsl variant of `mode` (skinning_defines)
+    void set_skinning(skinning_mode mode, cgp::opengl_shader_structure const& shader);
+
+    /// Projected height of the bounding sphere (fraction of the half screen),
+    /// and its distance to the camera in `distance` if given
+    float projected_size(cgp::mat4 const& view, cgp::mat4 const& projection, float* distance = nullptr) const;
+    /// Update `lod` from the projected size of the bounding sphere.
+    /// `bias` > 1 keeps the detailed levels further away.
+    void select_lod(cgp::mat4 const& view, cgp::mat4 const& projection, float bias = 1.0f);
+    /// Level for a projected size (biased) when `current` is drawn, among
+    /// `lod_count` levels: the thresholds and hysteresis of select_lod
+    static int lod_for_size(float size, int current, int lod_count);
+
+    /// One VAO bind, then one glDrawElements per submesh of level `lod`,
+    /// skinned by the pose given to the palette (bone_offset)
+    /// with its own texture and base color. `drawable.texture` is used for
+    /// the first submesh (the actor's own texture) and for submeshes without one.
+    /// `wireframe`: plain blue lines over the shaded mesh (CGP's
+    /// draw_wireframe cannot read the packed vertices).
+    /// @return the number of triangles drawn
+    size_t draw(cgp::environment_generic_structure const& environment, bool wireframe = false) const;
+    /// Same mesh, level and material, `instances` times in one glDrawElementsInstanced
+    /// per submesh: model matrix and bone offset of each from the palette's
+    /// instance table at `instance_table` (bone_palette::add_instance), -1: this actor only.
+    /// `baked`: posed at time `t` by that cycle instead, for the records with a
+    /// phase (ignored unless it is ready in this actor's skinning mode).
+    /// `level`: of res->lods to draw, -1: `lod`
+    size_t draw_instanced(cgp::environment_generic_structure const& environment,
+                          int instance_table, int instances, bool wireframe = false,
+                          baked_animation const* baked = nullptr, float t = 0.0f, int level = -1) const;
+    /// glDrawElements(Instanced) calls of a draw at `level` (-1: `lod`): one per submesh
+    size_t draw_calls(int level = -1) const;
+    /// Rest rotations (uBones follow at the next evaluate_pose())
     void reset_pose();    
 
     /*=============== construction ==================================*/
@@ -56,6 +155,29 @@ struct skinned_actor
     void load_from_gltf(const std::string& file,
                         const cgp::opengl_shader_structure& shader);
 
+    /*=============== asynchronous loading (see asset_pipeline) =====*/
+    /// CPU part of load_from_gltf: mesh cache or glTF parse, no OpenGL call (any thread)
+    static gltf_geometry_and_texture decode_gltf(const std::string& file);
+    /// GL part: upload decoded data and register it in resources(), so that
+    /// load_from_gltf(file, shader) finds it while the returned pointer lives
+    static std::shared_ptr<ActorResources> preload_gltf(const std::string& file,
+                             gltf_geometry_and_texture&& data,
+                             const cgp::opengl_shader_structure& shader);
+    /// Use `file` as drawable.texture (shared through resources())
+    void load_texture(const std::string& file);
+
+    GLint palette_location = -1;   ///< of uBonePalette in drawable.shader, -1 if absent
+    GLint offset_location  = -1;   ///< of uBoneOffset
+    GLint instance_location = -1;  ///< of uInstanceTable
+    GLint baked_location        = -1;   ///< of uBakedAnimation
+    GLint baked_frames_location = -1;   ///< of uBakedFrames
+    GLint baked_stride_location = -1;   ///< of uBakedStride
+    GLint baked_time_location   = -1;   ///< of uBakedTime
+
+    /// Define the joint groups of the species and keep their handles
+    /// (needs res and uBones, no OpenGL call).
+    virtual void define_groups() = 0;
+
     /**
      * Convenience: load, setup texture & joint groups all at once.
      */
@@ -67,4 +189,8 @@ struct skinned_actor
      * Generate wiggling animation on body, tail, fins and jaw.
      */
     virtual void animate(float t) = 0;
+
+    /// Period of animate(t) in seconds, 0 if it is not periodic (or a clip
+    /// is playing): what baked_animation samples
+    virtual float animation_period() const { return 0.0f; }
 };
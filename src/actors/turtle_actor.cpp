@@ -9,17 +9,17 @@ void turtle_actor::initialize(cgp::opengl_shader_structure const& shader,
                 std::string const& gltf_file,
                 std::string const& texture_file) {
     // load glTF
-    load_from_gltf(project::path + gltf_file, shader);
-    drawable.texture.load_and_initialize_texture_2d_on_gpu(
-        project::path + texture_file, GL_REPEAT, GL_REPEAT);
+    load_from_gltf(gltf_file, shader);
+    load_texture(texture_file);
 
-    data = mesh_load_file_gltf(project::path + "assets/sea_turtle/sea_turtle.gltf");
+    define_groups();
+}
 
-    // define joint groups
-    groups["RF"] = { 2,  3,  4,  5 };   // right-front flipper
-    groups["RR"] = { 6,  7,  8,  9 };   // right-rear
-    groups["LF"] = { 10, 11, 12, 13 };   // left-front
-    groups["LR"] = { 14, 15, 16, 17 };   // left-rear
+void turtle_actor::define_groups() {
+    rf = define_group("RF", { 2,  3,  4,  5 });   // right-front flipper
+    rr = define_group("RR", { 6,  7,  8,  9 });   // right-rear
+    lf = define_group("LF", { 10, 11, 12, 13 });   // left-front
+    lr = define_group("LR", { 14, 15, 16, 17 });   // left-rear
 }
 
 void turtle_actor::start_position() {
@@ -27,7 +27,6 @@ void turtle_actor::start_position() {
     drawable.model.rotation = rotation_transform::from_axis_angle({ 1, 0, 0 }, Pi / 2.0f);
     vec3 turtle_pos = { 0.2f, 0.4f, 0.5f };
     drawable.model.translation = turtle_pos;
-    upload_pose_to_gpu();
 }
 
 
@@ -36,15 +35,23 @@ void turtle_actor::start_position() {
  * Generate wiggling animation on body, tail, fins and jaw.
  */
 void turtle_actor::animate(float t) {
+    if (animate_clip(t)) return;   // authored clip playing
     aFront = front_amplitude * std::sin( front_frequency * t );        // front pair
     aRear  = rear_amplitude * std::sin( rear_frequency * t + cgp::Pi ); // rear 180°
 
     reset_pose();
-    rotate_group("RF", {0,0,1},  aFront);
-    rotate_group("LF", {0,0,1},  aFront);
-    rotate_group("RR", {0,0,1},  aRear );
-    rotate_group("LR", {0,0,1},  aRear );
-	upload_pose_to_gpu();  
+    rotate_group(rf, {0,0,1},  aFront);
+    rotate_group(lf, {0,0,1},  aFront);
+    rotate_group(rr, {0,0,1},  aRear );
+    rotate_group(lr, {0,0,1},  aRear );
+    evaluate_pose();
+}
+
+float turtle_actor::animation_period() const
+{
+    if (clip_player.playing() || front_frequency <= 0 || rear_frequency != front_frequency)
+        return 0.0f;
+    return 2 * cgp::Pi / front_frequency;   // sin(frequency * t)
 }
 
 
@@ -12,9 +12,9 @@ struct turtle_actor final: public skinned_actor {
     float        rear_frequency      = 2.0f;     ///< fin beat amplitude
     float aFront;
     float aRear;
+    group_handle rf = -1, rr = -1, lf = -1, lr = -1;   ///< flippers
 
-    gltf_geometry_and_texture data;
-
+    void define_groups() override;
     void initialize(cgp::opengl_shader_structure const& shader,
                     std::string const& gltf_file,
                     std::string const& texture_file) override;
@@ -32,5 +32,7 @@ struct turtle_actor final: public skinned_actor {
 
     bool check_for_collision(skinned_actor const& actor);
     void animate(float t) override;
+    /// 2 pi / frequency when both pairs beat at the same one
+    float animation_period() const override;
 };     
 
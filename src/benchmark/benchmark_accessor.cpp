@@ -0,0 +1,68 @@
+#include "benchmarks.hpp"
+#include "../loader/gltf_loader.hpp"
+#include "../loader/gltf_accessor.hpp"
+#include "../utils/process_memory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+void benchmark_accessors(std::vector<std::string> const& gltf_files, int repetitions)
+{
+    for (std::string const& file : gltf_files)
+    {
+        tinygltf::Model model = gltf_load_model(file);
+
+        size_t buffer_bytes = 0;
+        for (auto const& b : model.buffers) buffer_bytes += b.data.size();
+
+        std::cout << "\n[bench accessors] " << file << "\n"
+                  << "    " << model.buffers.size() << " buffer(s), " << buffer_bytes / 1024 << " KiB, "
+                  << model.accessors.size() << " accessors, " << repetitions << " repetitions\n";
+
+        double total_fast = 0, total_scalar = 0, max_error = 0;
+        size_t total_bytes = 0;
+
+        for (int a = 0; a < int(model.accessors.size()); ++a)
+        {
+            tinygltf::Accessor const& acc = model.accessors[a];
+            const int  components = tinygltf::GetNumComponentsInType(uint32_t(acc.type));
+            const bool as_uint    = !acc.normalized
+                                 && acc.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT
+                                 && acc.componentType != TINYGLTF_COMPONENT_TYPE_DOUBLE;
+            const size_t n = acc.count * size_t(components);
+            total_bytes += acc.count * size_t(components)
+                         * size_t(tinygltf::GetComponentSizeInBytes(uint32_t(acc.componentType)));
+
+            std::vector<float>    f_fast(n), f_ref(n);
+            std::vector<uint32_t> u_fast(n), u_ref(n);
+
+            auto run = [&](accessor_path path, float* f, uint32_t* u) {
+                auto t0 = std::chrono::steady_clock::now();
+                for (int r = 0; r < repetitions; ++r) {
+                    if (as_uint) accessor_read_uint (model, a, u, components, path);
+                    else         accessor_read_float(model, a, f, components, path);
+                }
+                return elapsed_ms(t0);
+            };
+            double t_fast   = run(accessor_path::fast,   f_fast.data(), u_fast.data());
+            double t_scalar = run(accessor_path::scalar, f_ref.data(),  u_ref.data());
+            total_fast   += t_fast;
+            total_scalar += t_scalar;
+
+            double err = 0;
+            for (size_t k = 0; k < n; ++k)
+                err = std::max(err, as_uint ? double(u_fast[k] != u_ref[k])
+                                            : double(std::abs(f_fast[k] - f_ref[k])));
+            max_error = std::max(max_error, err);
+        }
+
+        const double mb = to_mib(total_bytes) * repetitions;
+        std::cout << std::fixed << std::setprecision(2)
+                  << "    fast path : " << total_fast   << " ms  (" << mb / (total_fast   * 1e-3) << " MiB/s)\n"
+                  << "    scalar    : " << total_scalar << " ms  (" << mb / (total_scalar * 1e-3) << " MiB/s)\n"
+                  << "    speed-up  : " << total_scalar / std::max(total_fast, 1e-9) << "x,"
+                  << "  max |fast - scalar| = " << max_error << "\n";
+    }
+}
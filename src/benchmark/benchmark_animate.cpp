@@ -0,0 +1,122 @@
+#include "benchmarks.hpp"
+#include "../actors/shark_actor.hpp"
+#include "../actors/turtle_actor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+// The pose path animate() replaced: groups looked up by name through a
+// std::string key, and the rest pose inverse(inverse_bind[j]) recomputed for
+// every joint of every rotation, each joint on its own (no hierarchy)
+struct legacy_pose {
+    std::unordered_map<std::string, std::vector<int>> groups;
+
+    explicit legacy_pose(turtle_actor const&)
+        : groups{ {"RF", {2,3,4,5}}, {"RR", {6,7,8,9}}, {"LF", {10,11,12,13}}, {"LR", {14,15,16,17}} } {}
+    explicit legacy_pose(shark_actor const&)
+        : groups{ {"Tail", {6,7,8,9,10}}, {"Body0", {2}}, {"Body1", {3,17,18,19}}, {"Body2", {4,15,16}},
+                  {"Body3", {5,11,12,13,14}}, {"FinL", {20,21,22}}, {"FinR", {25,26,27}}, {"Jaw", {29,30}} } {}
+
+    void rotate_group(skinned_actor& actor, std::string_view group_name, cgp::vec3 axis, float angle_rad)
+    {
+        auto it = groups.find(std::string(group_name));
+        if (it == groups.end()) return;
+        for (int j : it->second) {
+            if (j >= int(actor.uBones.size())) continue;
+            cgp::mat4 bind = inverse(actor.res->inverse_bind[j]);
+            cgp::mat4 R = cgp::affine_rt(cgp::rotation_transform::from_axis_angle(axis, angle_rad),
+                                         {0,0,0}).matrix();
+            actor.uBones[j] = bind * R * actor.res->inverse_bind[j];
+        }
+    }
+
+    void animate(turtle_actor& a, float t)
+    {
+        a.aFront = a.front_amplitude * std::sin(a.front_frequency * t);
+        a.aRear  = a.rear_amplitude * std::sin(a.rear_frequency * t + cgp::Pi);
+        for (cgp::mat4& M : a.uBones) M = cgp::mat4::build_identity();
+        rotate_group(a, "RF", {0,0,1}, a.aFront);
+        rotate_group(a, "LF", {0,0,1}, a.aFront);
+        rotate_group(a, "RR", {0,0,1}, a.aRear);
+        rotate_group(a, "LR", {0,0,1}, a.aRear);
+    }
+
+    void animate(shark_actor& a, float t)
+    {
+        float w = 2*cgp::Pi*a.body_frequency;
+        std::array<std::string,4> seg = {"Body0","Body1","Body2","Body3"};
+        for (int i=0;i<seg.size();++i) {
+            float amp = a.body_amplitude * (a.amplitude_ratio + (1-a.amplitude_ratio)*(i/seg.size()));
+            rotate_group(a, seg[i], {0,0,1}, amp*std::sin(w*t - i*a.body_lag));
+        }
+        size_t last = seg.size() - 1;
+        float amp_last = a.body_amplitude * (a.amplitude_ratio + (1-a.amplitude_ratio)*(last/seg.size()));
+        rotate_group(a, "Tail", {0,0,1}, amp_last*std::sin(w*t - last*a.body_lag));
+        float fin = a.fin_amplitude * std::sin(w*t + cgp::Pi/2);
+        rotate_group(a, "FinL", {0,1,0},  fin);
+        rotate_group(a, "FinR", {0,1,0}, -fin);
+        rotate_group(a, "Jaw",  {1,0,0}, a.jaw_amplitude * std::max(0.f, std::sin(w*t)));
+    }
+};
+
+void bench_load_skeleton(skinned_actor& actor, std::string const& file)
+{
+    gltf_geometry_and_texture data = skinned_actor::decode_gltf(file);
+    auto R = std::make_shared<ActorResources>();
+    R->geometry     = std::move(data.geom);
+    R->joint_index  = std::move(data.joint_index);
+    R->joint_weight = std::move(data.joint_weight);
+    R->animations   = std::move(data.animations);
+    R->inverse_bind = std::move(data.inverse_bind);
+    R->skel.build(data.joint_parent, data.joint_rest, data.skeleton_base);
+    actor.res = R;
+    actor.uBones.assign(R->inverse_bind.size(), cgp::mat4::build_identity());
+    actor.pose.reset(R->skel);
+    actor.evaluate_pose();
+    actor.define_groups();
+}
+
+template <typename actor_type>
+static void bench_actor(char const* name, std::string const& file, int frames)
+{
+    actor_type actor;
+    bench_load_skeleton(actor, file);
+    legacy_pose legacy(actor);
+    float const dt = 1.0f / 60.0f;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < frames; ++k)
+        legacy.animate(actor, float(k) * dt);
+    double const before_ms = elapsed_ms(t0);
+
+    size_t evaluated = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < frames; ++k) {
+        actor.animate(float(k) * dt);
+        evaluated += actor.joints_evaluated;
+    }
+    double const after_ms = elapsed_ms(t0);
+
+    std::cout << "    " << std::left << std::setw(7) << name << std::right
+              << std::setw(3) << actor.uBones.size() << " joints, "
+              << std::setw(2) << actor.group_names.size() << " groups : "
+              << std::setw(8) << 1e3 * before_ms / frames << " us -> "
+              << std::setw(8) << 1e3 * after_ms / frames << " us per animate() ("
+              << before_ms / std::max(after_ms, 1e-6) << "x), "
+              << double(evaluated) / frames << " joints evaluated per frame\n";
+}
+
+void benchmark_animate(std::string const& turtle_gltf, std::string const& shark_gltf, int frames)
+{
+    std::streamsize const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3)
+              << "\n[bench animate] " << frames << " frames per actor, pose only (no upload)\n"
+              << "    before: name lookups, inverse per joint, no hierarchy;"
+                 " after: handles, hierarchy walk of the moved subtrees\n";
+    bench_actor<turtle_actor>("turtle", turtle_gltf, frames);
+    bench_actor<shark_actor>("shark", shark_gltf, frames);
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
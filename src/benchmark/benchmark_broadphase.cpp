@@ -0,0 +1,114 @@
+#include "benchmarks.hpp"
+#include "../actors/broadphase.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+/// Bodies swimming in a box, bouncing on its walls; the box grows with the
+/// count so that the density (and the pairs per body) stays the same
+struct moving_bodies {
+    std::vector<cgp::vec3> position, velocity;
+    std::vector<float>     radius;
+    float                  half_side = 0;
+
+    moving_bodies(size_t n, float density)
+    {
+        half_side = 0.5f * std::cbrt(float(n) / density);
+        std::mt19937 engine{ uint32_t(n) };
+        std::uniform_real_distribution<float> p(-half_side, half_side), v(-3.0f, 3.0f), r(0.3f, 0.7f);
+        for (size_t i = 0; i < n; ++i) {
+            position.push_back({ p(engine), p(engine), p(engine) });
+            velocity.push_back({ v(engine), v(engine), v(engine) });
+            radius.push_back(r(engine));
+        }
+    }
+
+    void move(float dt)
+    {
+        for (size_t i = 0; i < position.size(); ++i)
+            for (int c = 0; c < 3; ++c) {
+                position[i][c] += velocity[i][c] * dt;
+                if (std::abs(position[i][c]) > half_side) velocity[i][c] = -velocity[i][c];
+            }
+    }
+
+    /// Overlapping pairs, testing them all
+    size_t all_pairs() const
+    {
+        size_t found = 0;
+        for (size_t i = 0; i < position.size(); ++i)
+            for (size_t j = i + 1; j < position.size(); ++j) {
+                cgp::vec3 const d = position[j] - position[i];
+                float const r = radius[i] + radius[j];
+                found += d.x*d.x + d.y*d.y + d.z*d.z <= r * r ? 1 : 0;
+            }
+        return found;
+    }
+};
+
+} // namespace
+
+void benchmark_broadphase(int frames)
+{
+    constexpr float density = 0.05f;   // bodies per unit^3: a few neighbours each
+    float const dt = 1.0f / 60.0f;
+    thread_pool pool;
+
+    std::streamsize const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3)
+              << "\n[bench broadphase] hash grid, moving spheres (r 0.3 .. 0.7, " << density
+              << " per unit^3), " << frames << " frames, " << pool.size() + 1 << " threads when pooled\n";
+    double ms_per_test = 0;   // of the last measured all-pairs, to estimate the larger ones
+    for (size_t n : { size_t(1000), size_t(10000), size_t(100000) }) {
+        moving_bodies bodies(n, density);
+        hash_grid_broadphase grid;
+        std::vector<broadphase_pair> pairs;
+        double build_ms = 0, pairs_ms = 0, pooled_ms = 0;
+        size_t found = 0, tests = 0, cells = 0;
+        for (int f = 0; f < frames; ++f) {
+            bodies.move(dt);
+            grid.build(bodies.position.data(), bodies.radius.data(), n);
+            grid.find_pairs(pairs);
+            build_ms += grid.build_ms;
+            pairs_ms += grid.pairs_ms;
+            found    += grid.pairs;
+            tests    += grid.tests;
+            cells    += grid.cells;
+            grid.find_pairs(pairs, &pool);
+            pooled_ms += grid.pairs_ms;
+        }
+
+        // all pairs on the last frame (timed once, too slow at 100k: scaled from 10k)
+        bool const measured = n <= 10000;
+        size_t brute_pairs = 0;
+        double brute_ms = 0;
+        if (measured) {
+            auto t0 = std::chrono::steady_clock::now();
+            brute_pairs = bodies.all_pairs();
+            brute_ms = elapsed_ms(t0);
+        }
+        double const all_tests = double(n) * double(n - 1) / 2;
+        if (measured) ms_per_test = brute_ms / all_tests;
+        else          brute_ms = ms_per_test * all_tests;
+
+        double const grid_ms = (build_ms + pairs_ms) / frames;
+        std::cout << "    " << std::setw(6) << n << " bodies: build " << std::setw(7) << build_ms / frames
+                  << " ms, pairs " << std::setw(7) << pairs_ms / frames << " ms (pooled " << std::setw(7)
+                  << pooled_ms / frames << " ms), " << found / size_t(frames) << " pairs of "
+                  << tests / size_t(frames) << " tests in " << cells / size_t(frames) << " cells\n"
+                  << "                  all pairs: " << std::setw(9) << brute_ms << " ms"
+                  << (measured ? "" : " (estimated)") << ", " << std::setprecision(0) << all_tests
+                  << " tests -> grid " << std::setprecision(1) << brute_ms / std::max(grid_ms, 1e-9) << "x";
+        if (measured && brute_pairs == grid.pairs)
+            std::cout << ", same pairs";
+        else if (measured)
+            std::cout << ", pairs differ: " << brute_pairs << " vs " << grid.pairs;
+        std::cout << std::setprecision(3) << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
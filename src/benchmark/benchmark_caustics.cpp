@@ -0,0 +1,146 @@
+#include "benchmarks.hpp"
+#include "../loader/animated_texture.hpp"
+#include "../loader/texture_pack.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+// Full-screen triangle sampling one layer of the array with scaled uv:
+// scale > 1 is the view of a distant floor, scale_u << scale_v a grazing one
+static char const* sample_vertex_shader = R"(#version 330 core
+out vec2 uv;
+void main()
+{
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    uv = p;
+    gl_Position = vec4(2.0 * p - 1.0, 0.0, 1.0);
+}
+)";
+
+static char const* sample_fragment_shader = R"(#version 330 core
+in vec2 uv;
+out vec4 color;
+uniform sampler2DArray frames;
+uniform float scale_u;
+uniform float scale_v;
+uniform float layer;
+void main()
+{
+    color = vec4(texture(frames, vec3(uv * vec2(scale_u, scale_v), layer)).rrr, 1.0);
+}
+)";
+
+/// GPU milliseconds of one full-screen pass over the bound framebuffer
+static double sampling_ms(cgp::opengl_shader_structure const& shader, GLuint texture, int layers,
+                          float scale_u, float scale_v)
+{
+    constexpr int passes = 32;
+    glUseProgram(shader.id);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    cgp::opengl_uniform(shader, "frames",  0);
+    cgp::opengl_uniform(shader, "scale_u", scale_u);
+    cgp::opengl_uniform(shader, "scale_v", scale_v);
+
+    cgp::opengl_uniform(shader, "layer", 0.0f);
+    glDrawArrays(GL_TRIANGLES, 0, 3);                   // warm up
+    glFinish();
+
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    for (int k = 0; k < passes; ++k) {
+        cgp::opengl_uniform(shader, "layer", float(k % layers));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+    glDeleteQueries(1, &query);
+    return double(ns) * 1e-6 / passes;
+}
+
+void benchmark_caustics(std::string const& base, int frame_count)
+{
+    std::vector<std::string> const frames = sequence_frame_names(base, frame_count);
+
+    // the baker needs no GL: do it first so that its timings stay apart
+    if (!texture_pack_open_fresh(base, frames))
+        texture_pack_bake(base, frames);
+
+    cgp::window_structure window;
+    window.initialize_glfw();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window.create_window(64, 64, "bench", CGP_OPENGL_VERSION_MAJOR, CGP_OPENGL_VERSION_MINOR);
+
+    std::cout << std::fixed << std::setprecision(2) << "\n[bench caustics] " << base << "\n";
+
+    /* ---- load: decode every JPEG vs one mapping -------------------------- */
+    auto t0 = std::chrono::steady_clock::now();
+    std::shared_ptr<texture_array_resource> jpeg =
+        create_texture_array_from_sequence(base, frame_count, 4, image_format::jpg, /*use_pack=*/false);
+    glFinish();
+    double const jpeg_ms = elapsed_ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    std::shared_ptr<texture_array_resource> packed = create_texture_array_from_sequence(base, frame_count);
+    glFinish();
+    double const pack_ms = elapsed_ms(t0);
+
+    if (!jpeg || !packed) {
+        std::cerr << "[bench caustics] cannot load " << base << std::endl;
+        jpeg.reset();     // while the context is current
+        packed.reset();
+        glfwDestroyWindow(window.glfw_window);
+        glfwTerminate();
+        return;
+    }
+    std::cout << "    load   JPEG (decode + upload, 1 level) : " << std::setw(8) << jpeg_ms << " ms, "
+              << jpeg->gpu_bytes / 1024 << " KiB GPU\n"
+              << "    load   pack (mapped, full mip chains)  : " << std::setw(8) << pack_ms << " ms, "
+              << packed->gpu_bytes / 1024 << " KiB GPU\n";
+
+    /* ---- sampling: full-screen passes into a 1024² target --------------- */
+    constexpr int size = 1024;
+    GLuint fbo = 0, color = 0, vao = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size, size);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glViewport(0, 0, size, size);
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glDisable(GL_DEPTH_TEST);
+
+    cgp::opengl_shader_structure shader;
+    shader.load_from_inline_text(sample_vertex_shader, sample_fragment_shader);
+
+    struct view { char const* name; float scale_u, scale_v; };
+    view const views[] = {
+        { "magnified (0.5x)    ",  0.5f,  0.5f },
+        { "minified (8x)       ",  8.0f,  8.0f },
+        { "minified (32x)      ", 32.0f, 32.0f },
+        { "grazing (1x : 32x)  ",  1.0f, 32.0f },
+    };
+    std::cout << "    sampling, GPU ms per 1024x1024 pass       JPEG      pack\n";
+    for (view const& v : views) {
+        double const a = sampling_ms(shader, jpeg->id,   jpeg->layers,   v.scale_u, v.scale_v);
+        double const b = sampling_ms(shader, packed->id, packed->layers, v.scale_u, v.scale_v);
+        std::cout << "      " << v.name << "                 " << std::setw(8) << a
+                  << "  " << std::setw(8) << b << "\n";
+    }
+
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &vao);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteProgram(shader.id);
+    jpeg.reset();
+    packed.reset();
+
+    glfwDestroyWindow(window.glfw_window);
+    glfwTerminate();
+}
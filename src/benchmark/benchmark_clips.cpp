@@ -0,0 +1,160 @@
+#include "benchmarks.hpp"
+#include "../loader/gltf_loader.hpp"
+#include "../loader/gltf_animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+/// A long clip of every path and interpolation (the assets may have none,
+/// or only linear ones): `keys` keys per channel, 30 per second
+gltf_animation_set synthetic_clips(uint32_t keys)
+{
+    gltf_animation_set set;
+    gltf_animation_clip clip;
+    std::strncpy(clip.name, "synthetic", sizeof(clip.name) - 1);
+    clip.duration = float(keys - 1) / 30.0f;
+    clip.channel_count = 4;
+    set.clips.push_back(clip);
+    for (uint32_t k = 0; k < keys; ++k) set.times.push_back(float(k) / 30.0f);
+
+    auto add = [&](gltf_channel_path path, gltf_interpolation interpolation, int joint) {
+        gltf_animation_channel c;
+        c.joint         = joint;
+        c.path          = uint8_t(path);
+        c.interpolation = uint8_t(interpolation);
+        c.components    = path == gltf_channel_path::rotation ? 4 : 3;
+        c.key_count     = keys;
+        c.first_value   = uint32_t(set.values.size());
+        for (uint32_t k = 0; k < c.key_count * c.key_values(); ++k) {
+            float const t = float(k / c.key_values()) / 30.0f;
+            if (path == gltf_channel_path::rotation) {   // about a wobbling axis
+                float const a = 0.5f * std::sin(1.3f * t), b = 0.5f * std::sin(0.7f * t + 1.0f);
+                float const l = std::sqrt(1 + a * a + b * b);
+                float const half = 0.5f * std::sin(2.1f * t) + 0.2f;
+                float const s = std::sin(half) / l;
+                for (float v : { a * s, b * s, s, std::cos(half) }) set.values.push_back(v);
+            } else if (interpolation == gltf_interpolation::step) {   // held for a second: reducible
+                for (int j = 0; j < 3; ++j) set.values.push_back(1.0f + 0.25f * std::floor(t + float(j) / 3));
+            } else if (c.key_values() == 3 && k % 3 != 1) {   // tangents
+                for (int j = 0; j < 3; ++j) set.values.push_back(2.0f * std::cos(2.0f * t + float(j)));
+            } else {
+                for (int j = 0; j < 3; ++j) set.values.push_back(std::sin(2.0f * t + float(j)) + float(j));
+            }
+        }
+        set.channels.push_back(c);
+    };
+    add(gltf_channel_path::translation, gltf_interpolation::linear,       0);
+    add(gltf_channel_path::rotation,    gltf_interpolation::linear,       0);
+    add(gltf_channel_path::scale,       gltf_interpolation::step,         1);
+    add(gltf_channel_path::translation, gltf_interpolation::cubic_spline, 1);
+    return set;
+}
+
+/// Every channel of `set` played forward at 240 Hz: cursor vs a fresh
+/// cursor (binary search) per sample, then jumping at random. @return the
+/// samples that differ; samples and time of both ways added to the others
+size_t check_cursor(gltf_animation_set const& set, double& cursor_ns, double& search_ns, size_t& samples)
+{
+    size_t differ = 0;
+    std::vector<float> times;
+    std::mt19937 engine{ 7 };
+    for (gltf_animation_clip const& clip : set.clips) {
+        times.clear();
+        for (float t = -0.1f; t < clip.duration + 0.1f; t += 1.0f / 240.0f) times.push_back(t);
+        size_t const forward = times.size();
+        std::uniform_real_distribution<float> anywhere(-0.1f, clip.duration + 0.1f);
+        for (size_t k = 0; k < forward; ++k) times.push_back(anywhere(engine));
+
+        for (uint32_t ch = clip.first_channel; ch < clip.first_channel + clip.channel_count; ++ch) {
+            gltf_animation_channel const& c = set.channels[ch];
+            std::vector<float> played(4 * times.size()), searched(4 * times.size());
+            uint32_t cursor = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < times.size(); ++k)
+                gltf_sample_channel(set, c, cursor, times[k], &played[4 * k]);
+            cursor_ns += 1e6 * elapsed_ms(t0);
+            t0 = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < times.size(); ++k) {
+                uint32_t fresh = ~0u;
+                gltf_sample_channel(set, c, fresh, times[k], &searched[4 * k]);
+            }
+            search_ns += 1e6 * elapsed_ms(t0);
+            for (size_t k = 0; k < times.size(); ++k)
+                differ += std::memcmp(&played[4 * k], &searched[4 * k], c.components * sizeof(float)) != 0 ? 1 : 0;
+            samples += times.size();
+        }
+    }
+    return differ;
+}
+
+/// Largest difference (any component) between the curves of `floats` and
+/// those of its quantized copy, sampled at 240 Hz
+float quantization_error(gltf_animation_set const& floats, gltf_animation_set const& quantized)
+{
+    float worst = 0;
+    for (gltf_animation_clip const& clip : floats.clips)
+        for (uint32_t ch = clip.first_channel; ch < clip.first_channel + clip.channel_count; ++ch) {
+            gltf_animation_channel const& a = floats.channels[ch];
+            gltf_animation_channel const& b = quantized.channels[ch];
+            uint32_t ca = 0, cb = 0;
+            for (float t = 0; t <= clip.duration; t += 1.0f / 240.0f) {
+                float va[4], vb[4];
+                gltf_sample_channel(floats, a, ca, t, va);
+                gltf_sample_channel(quantized, b, cb, t, vb);
+                for (int i = 0; i < a.components; ++i) worst = std::max(worst, std::abs(va[i] - vb[i]));
+            }
+        }
+    return worst;
+}
+
+void report(std::string const& name, gltf_animation_set const& loaded, size_t raw_keys, size_t raw_bytes)
+{
+    if (loaded.clips.empty()) {
+        std::cout << "    " << name << ": no clips\n";
+        return;
+    }
+    gltf_animation_set quantized = loaded;
+    gltf_quantize_animations(quantized);
+
+    double cursor_ns = 0, search_ns = 0;
+    size_t samples = 0;
+    size_t const differ = check_cursor(loaded, cursor_ns, search_ns, samples)
+                        + check_cursor(quantized, cursor_ns, search_ns, samples);
+
+    std::cout << "    " << name << ": " << loaded.clips.size() << " clips, " << loaded.channels.size() << " channels\n"
+              << "        keys      : " << std::setw(8) << raw_keys << " -> " << std::setw(8) << loaded.key_count()
+              << " reduced\n"
+              << "        bytes     : " << std::setw(8) << raw_bytes << " -> " << std::setw(8) << loaded.bytes()
+              << " reduced -> " << std::setw(8) << quantized.bytes() << " quantized\n"
+              << "        quantized : max error " << std::scientific << std::setprecision(2)
+              << quantization_error(loaded, quantized) << std::fixed << " against the float curves\n"
+              << "        sampling  : " << std::setprecision(1) << cursor_ns / std::max<size_t>(samples, 1)
+              << " ns with the cursor, " << search_ns / std::max<size_t>(samples, 1) << " ns searching; "
+              << (differ == 0 ? "same values" : "VALUES DIFFER") << " (" << differ << " of " << samples << ")\n";
+}
+
+} // namespace
+
+void benchmark_clips(std::vector<std::string> const& gltf_files)
+{
+    std::streamsize const precision = std::cout.precision();
+    std::cout << std::fixed << "\n[bench clips] glTF clips: reduced and quantized storage, cursor vs binary search\n";
+    for (std::string const& file : gltf_files) {
+        // reduced by the loader already: no "before" for the keys
+        gltf_geometry_and_texture data = mesh_load_file_gltf(file, /*load_texture=*/false, /*optimize=*/false);
+        report(file, data.animations, data.animations.key_count(), data.animations.bytes());
+    }
+    for (uint32_t keys : { 100u, 10000u }) {
+        gltf_animation_set set = synthetic_clips(keys);
+        size_t const raw_keys = set.key_count(), raw_bytes = set.bytes();
+        gltf_reduce_animations(set, 1e-5f);
+        report("synthetic, " + std::to_string(keys) + " keys per channel (linear, step, cubic)", set, raw_keys, raw_bytes);
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
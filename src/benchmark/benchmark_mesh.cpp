@@ -0,0 +1,68 @@
+#include "benchmarks.hpp"
+#include "../loader/gltf_loader.hpp"
+#include "../loader/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+/// Bytes read from the position stream through a small LRU of 64-byte lines,
+/// over the bytes actually needed (1 = every line fetched once)
+static double position_overfetch(cgp::numarray<cgp::uint3> const& triangles, size_t vertex_count)
+{
+    constexpr size_t line = 64, stride = sizeof(cgp::vec3), lines_kept = 8;
+    std::vector<size_t> lru;
+    size_t fetched = 0;
+    for (cgp::uint3 const& t : triangles.data)
+        for (int c = 0; c < 3; ++c) {
+            size_t const first = t[c] * stride / line, last = (t[c] * stride + stride - 1) / line;
+            for (size_t l = first; l <= last; ++l) {
+                auto it = std::find(lru.begin(), lru.end(), l);
+                if (it != lru.end()) lru.erase(it);
+                else { ++fetched; if (lru.size() == lines_kept) lru.erase(lru.begin()); }
+                lru.push_back(l);
+            }
+        }
+    double const needed = double(vertex_count * stride + line - 1) / line;
+    return double(fetched) / needed;
+}
+
+void benchmark_mesh_optimizer(std::vector<std::string> const& gltf_files)
+{
+    std::streamsize const precision = std::cout.precision();
+    for (std::string const& file : gltf_files)
+    {
+        gltf_geometry_and_texture data = mesh_load_file_gltf(file, /*load_texture=*/false, /*optimize=*/false);
+        size_t const vertices_before = data.geom.position.size();
+        size_t const triangles       = data.geom.connectivity.size();
+
+        vertex_cache_stats const before16 = analyze_vertex_cache(data.geom.connectivity, vertices_before, 16);
+        vertex_cache_stats const before32 = analyze_vertex_cache(data.geom.connectivity, vertices_before, 32);
+        double const fetch_before = position_overfetch(data.geom.connectivity, vertices_before);
+
+        auto t0 = std::chrono::steady_clock::now();
+        mesh_optimize(data);
+        double const ms = elapsed_ms(t0);
+
+        size_t const vertices_after = data.geom.position.size();
+        vertex_cache_stats const after16 = analyze_vertex_cache(data.geom.connectivity, vertices_after, 16);
+        vertex_cache_stats const after32 = analyze_vertex_cache(data.geom.connectivity, vertices_after, 32);
+        double const fetch_after = position_overfetch(data.geom.connectivity, vertices_after);
+        size_t const index_bytes = vertices_after < 0xFFFF ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        std::cout << "\n[bench meshopt] " << file << "\n"
+                  << "    " << triangles << " triangles in " << data.submeshes.size() << " submesh(es), "
+                  << vertices_before << " -> " << vertices_after << " vertices, optimized in "
+                  << std::fixed << std::setprecision(2) << ms << " ms\n"
+                  << std::setprecision(3)
+                  << "                    before   after\n"
+                  << "    ACMR (FIFO 16)  " << std::setw(6) << before16.acmr << "  " << std::setw(6) << after16.acmr << "\n"
+                  << "    ATVR (FIFO 16)  " << std::setw(6) << before16.atvr << "  " << std::setw(6) << after16.atvr << "\n"
+                  << "    ACMR (FIFO 32)  " << std::setw(6) << before32.acmr << "  " << std::setw(6) << after32.acmr << "\n"
+                  << "    ATVR (FIFO 32)  " << std::setw(6) << before32.atvr << "  " << std::setw(6) << after32.atvr << "\n"
+                  << "    overfetch       " << std::setw(6) << fetch_before  << "  " << std::setw(6) << fetch_after  << "\n"
+                  << "    index buffer    " << std::setw(6) << triangles * 3 * sizeof(uint32_t) / 1024 << "  "
+                  << std::setw(6) << triangles * 3 * index_bytes / 1024 << " KiB\n";
+        std::cout << std::defaultfloat << std::setprecision(precision);
+    }
+}
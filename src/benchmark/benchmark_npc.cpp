@@ -0,0 +1,98 @@
+#include "benchmarks.hpp"
+#include "../actors/npc_manager.hpp"
+#include "../actors/shark_actor.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+
+namespace {
+
+/// Same lives for both paths: across a 60 x 60 area, 2 to 8 units/s
+struct npc_paths {
+    std::mt19937 engine{ 7 };
+    std::uniform_real_distribution<float> xy{ -30.0f, 30.0f }, z{ -0.5f, 3.0f }, swim{ 2.0f, 8.0f };
+
+    void next(cgp::vec3& origin, cgp::vec3& goal, float& speed)
+    {
+        origin = { xy(engine), xy(engine), z(engine) };
+        goal   = { xy(engine), xy(engine), z(engine) };
+        speed  = swim(engine);
+    }
+};
+
+} // namespace
+
+void benchmark_npc(std::string const& shark_gltf, int npcs, int frames)
+{
+    shark_actor prototype;
+    bench_load_skeleton(prototype, shark_gltf);
+    float const dt = 1.0f / 60.0f;
+
+    // as the scene did it: one shark_actor each, update_position + check_for_end_of_life
+    double actor_ms = 0;
+    size_t actor_bytes = 0;
+    {
+        npc_paths paths;
+        std::vector<shark_actor> actors(size_t(npcs), prototype);
+        for (shark_actor& a : actors) paths.next(a.origin, a.target, a.speed);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f)
+            for (shark_actor& a : actors) {
+                a.update_position(dt);
+                if (a.check_for_end_of_life()) paths.next(a.origin, a.target, a.speed);
+            }
+        actor_ms = elapsed_ms(t0);
+        actor_bytes = sizeof(shark_actor);
+    }
+
+    // pooled structure-of-arrays, on 1, 2, 4 … hardware threads
+    npc_manager pool_npcs;
+    int const kind = pool_npcs.add_species(prototype);
+    pool_npcs.reserve(size_t(npcs));
+    unsigned const hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < hardware; n *= 2) counts.push_back(n);
+    counts.push_back(hardware);
+
+    std::streamsize const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2)
+              << "\n[bench npc] " << npcs << " sharks, " << frames << " frames (move, orient, end of life, respawn)\n"
+              << "    shark_actor path : " << std::setw(8) << double(npcs) * frames / (1e3 * actor_ms)
+              << " M updates/s (" << actor_bytes << " bytes per actor)\n";
+    for (unsigned threads : counts) {
+        std::unique_ptr<thread_pool> workers;
+        if (threads > 1) workers = std::make_unique<thread_pool>(threads - 1);
+        npc_paths paths;
+        pool_npcs.clear();
+        for (int k = 0; k < npcs; ++k) {
+            cgp::vec3 origin, goal;
+            float speed;
+            paths.next(origin, goal, speed);
+            pool_npcs.spawn(kind, origin, goal, speed, 0.0f);
+        }
+        size_t const slots = pool_npcs.capacity();
+        size_t respawns = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            pool_npcs.update(dt, workers.get());
+            for (npc_manager::handle h : pool_npcs.expired()) {
+                cgp::vec3 origin, goal;
+                float speed;
+                paths.next(origin, goal, speed);
+                pool_npcs.respawn(h, origin, goal, speed);
+            }
+            respawns += pool_npcs.expired().size();
+        }
+        double const ms   = elapsed_ms(t0);
+        double const rate = double(npcs) * frames / (1e3 * ms);
+        std::cout << "    npc_manager " << std::setw(2) << threads << " thr: " << std::setw(8) << rate
+                  << " M updates/s (" << rate / (double(npcs) * frames / (1e3 * actor_ms)) << "x), "
+                  << respawns << " respawns, slots " << slots << " -> " << pool_npcs.capacity() << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
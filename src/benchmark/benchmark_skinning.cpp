@@ -0,0 +1,92 @@
+#include "benchmarks.hpp"
+#include "../actors/cpu_skinning.hpp"
+#include "../actors/shark_actor.hpp"
+#include "../loader/packed_vertex.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+/// Vertex v as turtle.vert.glsl skins it (4x4 matrix path): packed inputs,
+/// blended matrix applied to the dequantized position and normal
+static void shader_reference(packed_skin_mesh const& packed, std::vector<cgp::mat4> const& bones, size_t v,
+                             cgp::vec3& position, cgp::vec3& normal)
+{
+    packed_skin_vertex const& p = packed.vertices[v];
+    cgp::vec3 const P = unpack_position(packed, p);
+    cgp::vec3 const N = unpack_normal(p);
+    cgp::vec4 const w = unpack_weights(p);
+    float S[4][4] = {};
+    for (int k = 0; k < 4; ++k)
+        for (int row = 0; row < 4; ++row)
+            for (int col = 0; col < 4; ++col)
+                S[row][col] += w[k] * bones[p.joints[k]](row, col);
+    for (int row = 0; row < 3; ++row) {
+        position[row] = S[row][0]*P.x + S[row][1]*P.y + S[row][2]*P.z + S[row][3];
+        normal[row]   = S[row][0]*N.x + S[row][1]*N.y + S[row][2]*N.z;
+    }
+    normal = normalize(normal);
+}
+
+void benchmark_skinning(std::string const& shark_gltf, int repetitions)
+{
+    // the shark's mesh and skeleton, posed mid-stroke (no OpenGL)
+    shark_actor shark;
+    bench_load_skeleton(shark, shark_gltf);
+    std::shared_ptr<ActorResources> const R = shark.res;
+    shark.animate(0.37f);
+
+    size_t const n = R->geometry.position.size();
+    thread_pool pool;
+    cpu_skinned_mesh scalar, fast, threaded;
+
+    auto vertices_per_s = [&](cpu_skinned_mesh& out, thread_pool* p, cpu_skin_path path) {
+        cpu_skin(*R, shark.uBones, out, p, path);   // warm up (allocations)
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < repetitions; ++k)
+            cpu_skin(*R, shark.uBones, out, p, path);
+        return double(n) * repetitions / (1e-3 * std::max(elapsed_ms(t0), 1e-6));
+    };
+    double const scalar_rate   = vertices_per_s(scalar, nullptr, cpu_skin_path::scalar);
+    double const fast_rate     = vertices_per_s(fast, nullptr, cpu_skin_path::fast);
+    double const threaded_rate = vertices_per_s(threaded, &pool, cpu_skin_path::fast);
+
+    // fast / threaded kernels against the scalar one, and against the shader
+    // math on the quantized vertex it reads
+    packed_skin_mesh const packed = pack_skin_vertices(R->geometry, R->joint_index, R->joint_weight);
+    float const extent = std::max({ packed.position_scale.x, packed.position_scale.y, packed.position_scale.z });
+    float err_fast = 0, err_shader = 0, err_normal_deg = 0;
+    for (size_t v = 0; v < n; ++v) {
+        err_fast = std::max({ err_fast, norm(fast.position[v] - scalar.position[v]) / extent,
+                              norm(threaded.position[v] - scalar.position[v]) / extent });
+        cgp::vec3 P, N;
+        shader_reference(packed, shark.uBones, v, P, N);
+        err_shader = std::max(err_shader, norm(P - scalar.position[v]) / extent);
+        float const c = std::clamp(dot(N, scalar.normal[v]), -1.0f, 1.0f);
+        err_normal_deg = std::max(err_normal_deg, std::acos(c) * 180.0f / 3.14159265f);
+    }
+
+    cgp::vec3 rest_min, rest_max;
+    R->geometry.get_bounding_box_position(rest_min, rest_max);
+
+    std::streamsize const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2)
+              << "\n[bench skinning] " << shark_gltf << "\n"
+              << "    " << n << " vertices, " << shark.uBones.size() << " joints, "
+              << repetitions << " passes each\n"
+              << "    scalar          : " << std::setw(8) << scalar_rate / 1e6 << " Mvertices/s\n"
+              << "    " << std::left << std::setw(16) << cpu_skin_fast_kernel() << std::right << ": "
+              << std::setw(8) << fast_rate / 1e6 << " Mvertices/s (" << fast_rate / scalar_rate << "x)\n"
+              << "    " << std::left << std::setw(16) << (std::string(cpu_skin_fast_kernel()) + ", "
+                                                         + std::to_string(pool.size() + 1) + " thr")
+              << std::right << ": " << std::setw(8) << threaded_rate / 1e6 << " Mvertices/s ("
+              << threaded_rate / scalar_rate << "x)\n"
+              << std::setprecision(6)
+              << "    max difference  : fast " << err_fast << " x extent, vs shader math "
+              << err_shader << " x extent (quantization), normal " << err_normal_deg << " deg\n"
+              << "    bounds          : rest " << rest_min << " .. " << rest_max
+              << ", posed " << scalar.bounds_min << " .. " << scalar.bounds_max << "\n";
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
@@ -0,0 +1,72 @@
+#include "benchmarks.hpp"
+#include "../loader/texture_loader.hpp"
+#include "../utils/process_memory.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+/// The path texture_upload_raw replaced: every pixel converted to a float
+/// grid_2D<vec3> (alpha dropped), then uploaded by CGP.
+static void upload_through_float_grid(decoded_image const& im, cgp::opengl_texture_image_structure& tex)
+{
+    cgp::grid_2D<cgp::vec3> rgb;
+    rgb.resize(im.width, im.height);
+
+    unsigned char const* src = im.pixels.get();
+    for (int y = 0; y < im.height; ++y)
+    for (int x = 0; x < im.width; ++x)
+    {
+        int i = (y * im.width + x) * im.components;
+        int g = im.components >= 3 ? 1 : 0, b = im.components >= 3 ? 2 : 0;
+        rgb(x, y) = { src[i] / 255.0f, src[i + g] / 255.0f, src[i + b] / 255.0f };
+    }
+    tex.initialize_texture_2d_on_gpu(rgb, GL_REPEAT, GL_REPEAT, /*is_mipmap=*/true);
+}
+
+void benchmark_textures(std::vector<std::string> const& image_files)
+{
+    // uploads need a GL context: use a hidden window
+    cgp::window_structure window;
+    window.initialize_glfw();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window.create_window(64, 64, "bench", CGP_OPENGL_VERSION_MAJOR, CGP_OPENGL_VERSION_MINOR);
+
+    // Peak RSS only grows: run the lean path over every file first
+    struct path { char const* name; bool raw; };
+    path const paths[] = { { "raw 8-bit      ", true }, { "float grid_2D  ", false } };
+
+    size_t const rss_start = process_peak_rss_bytes();
+    std::cout << std::fixed << std::setprecision(2)
+              << "\n[bench textures] peak RSS at start: " << to_mib(rss_start) << " MiB\n";
+
+    for (path const& p : paths)
+    {
+        size_t const rss_before = process_peak_rss_bytes();
+        double total_ms = 0;
+        for (std::string const& file : image_files)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            decoded_image im = texture_decode_file(file);
+            double const decode_ms = elapsed_ms(t0);
+
+            t0 = std::chrono::steady_clock::now();
+            cgp::opengl_texture_image_structure tex;
+            if (p.raw) texture_upload_raw(tex, im);
+            else       upload_through_float_grid(im, tex);
+            glFinish();
+            double const upload_ms = elapsed_ms(t0);
+            total_ms += decode_ms + upload_ms;
+
+            std::cout << "    " << p.name << file << " (" << im.width << "x" << im.height
+                      << "x" << im.components << "): decode " << decode_ms
+                      << " ms, convert+upload " << upload_ms << " ms\n";
+            glDeleteTextures(1, &tex.id);
+        }
+        size_t const rss_after = process_peak_rss_bytes();
+        std::cout << "    " << p.name << "total " << total_ms << " ms, peak RSS "
+                  << to_mib(rss_after) << " MiB (+" << to_mib(rss_after - rss_before) << " MiB)\n";
+    }
+
+    glfwDestroyWindow(window.glfw_window);
+    glfwTerminate();
+}
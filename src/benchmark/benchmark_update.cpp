@@ -0,0 +1,42 @@
+#include "benchmarks.hpp"
+#include "../actors/shark_school.hpp"
+#include "../utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+void benchmark_update(std::string const& shark_gltf, int actors, int frames)
+{
+    shark_actor prototype;
+    bench_load_skeleton(prototype, shark_gltf);
+    shark_school school;
+    school.resize(actors, prototype);
+
+    unsigned const hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < hardware; n *= 2) counts.push_back(n);
+    counts.push_back(hardware);
+
+    std::streamsize const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3)
+              << "\n[bench update] " << actors << " sharks, " << frames << " frames, "
+              << prototype.uBones.size() << " joints each (animate + pose evaluation)\n";
+    double single_ms = 0;
+    float const dt = 1.0f / 60.0f;
+    for (unsigned threads : counts) {
+        std::unique_ptr<thread_pool> pool;
+        if (threads > 1) pool = std::make_unique<thread_pool>(threads - 1);
+        school.animate(0, pool.get());   // warm up
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < frames; ++k)
+            school.animate(float(k) * dt, pool.get());
+        double const ms = elapsed_ms(t0) / frames;
+        if (threads == 1) single_ms = ms;
+        std::cout << "    " << std::setw(3) << threads << " threads : " << std::setw(8) << ms
+                  << " ms per update phase (" << single_ms / std::max(ms, 1e-9) << "x)\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+}
@@ -0,0 +1,54 @@
+#include "benchmarks.hpp"
+#include "../loader/gltf_loader.hpp"
+#include "../loader/packed_vertex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+void benchmark_vertex_format(std::vector<std::string> const& gltf_files)
+{
+    std::streamsize const precision = std::cout.precision();
+    for (std::string const& file : gltf_files)
+    {
+        gltf_geometry_and_texture data = mesh_load_file_gltf(file, /*load_texture=*/false);
+        size_t const n = data.geom.position.size();
+
+        auto t0 = std::chrono::steady_clock::now();
+        packed_skin_mesh const packed = pack_skin_vertices(data.geom, data.joint_index, data.joint_weight);
+        double const ms = elapsed_ms(t0);
+
+        // worst decoding error, relative to the bounding box for positions
+        float extent = std::max({ packed.position_scale.x, packed.position_scale.y, packed.position_scale.z });
+        float err_position = 0, err_normal_deg = 0, err_uv = 0, err_weight = 0;
+        bool const skinned = data.joint_weight.size() == n;
+        for (size_t v = 0; v < n; ++v) {
+            packed_skin_vertex const& p = packed.vertices[v];
+            err_position = std::max(err_position, norm(unpack_position(packed, p) - data.geom.position[v]) / extent);
+            float const c = std::clamp(dot(unpack_normal(p), normalize(data.geom.normal[v])), -1.0f, 1.0f);
+            err_normal_deg = std::max(err_normal_deg, std::acos(c) * 180.0f / 3.14159265f);
+            err_uv = std::max(err_uv, norm(unpack_uv(p) - data.geom.uv[v]));
+            if (skinned) {
+                cgp::vec4 const w = data.joint_weight[v];
+                float const sum = w.x + w.y + w.z + w.w;
+                cgp::vec4 const u = unpack_weights(p);
+                for (int k = 0; k < 4; ++k)
+                    if (sum > 0) err_weight = std::max(err_weight, std::abs(u[k] - w[k] / sum));
+            }
+        }
+
+        size_t const before = n * float_skin_vertex_bytes, after = n * sizeof(packed_skin_vertex);
+        std::cout << "\n[bench vertex] " << file << "\n"
+                  << "    " << n << " vertices, packed in " << std::fixed << std::setprecision(2) << ms << " ms\n"
+                  << "    float streams : " << std::setw(3) << float_skin_vertex_bytes << " B/vertex, "
+                  << std::setw(8) << before / 1024.0 << " KiB in 6 VBOs\n"
+                  << "    packed        : " << std::setw(3) << sizeof(packed_skin_vertex) << " B/vertex, "
+                  << std::setw(8) << after / 1024.0 << " KiB in 1 VBO  ("
+                  << 100.0 * (1.0 - double(after) / double(before)) << "% less)\n"
+                  << std::setprecision(6)
+                  << "    max error     : position " << err_position << " x extent, normal "
+                  << err_normal_deg << " deg, uv " << err_uv << ", weight " << err_weight << "\n";
+        std::cout << std::defaultfloat << std::setprecision(precision);
+    }
+}
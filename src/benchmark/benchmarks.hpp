@@ -0,0 +1,65 @@
+#pragma once
+// benchmarks.hpp
+// Headless micro-benchmarks, run with  ./project --bench <name>
+// (see scene_structure::run_benchmark for the list of names).
+
+#include <string>
+#include <vector>
+#include "../utils/timing.hpp"
+
+struct skinned_actor;
+
+/// Mesh, skin, clips and skeleton of `file` into `actor`, as load_from_gltf
+/// leaves them, groups defined (no OpenGL)
+void bench_load_skeleton(skinned_actor& actor, std::string const& file);
+
+/// Decode every accessor of the given glTF files, fast path vs scalar reference
+void benchmark_accessors(std::vector<std::string> const& gltf_files, int repetitions = 50);
+
+/// Decode + upload the given image files, raw 8-bit path vs float grid_2D<vec3>,
+/// with the peak resident memory after each (needs a display: opens a hidden window)
+void benchmark_textures(std::vector<std::string> const& image_files);
+
+/// Vertex cache (ACMR / ATVR), vertex fetch and index size of the given glTF
+/// meshes, as loaded vs after mesh_optimize
+void benchmark_mesh_optimizer(std::vector<std::string> const& gltf_files);
+
+/// Vertex buffer size and worst quantization error of the packed skinned
+/// vertex, against the float streams it replaces
+void benchmark_vertex_format(std::vector<std::string> const& gltf_files);
+
+/// Load time of the frame sequence `base` (JPEG decode vs baked pack, baked
+/// first if needed) and GPU time of sampling it minified and at grazing
+/// angles, without mips vs the pack's mip chain (needs a display)
+void benchmark_caustics(std::string const& base, int frame_count);
+
+/// Clips of the given glTF files and synthetic ones (step, linear, cubic):
+/// bytes as loaded, keyframe-reduced and quantized, largest quantization
+/// error against the float curves, and cursor sampling checked against
+/// binary search (same values) and timed; no OpenGL
+void benchmark_clips(std::vector<std::string> const& gltf_files);
+
+/// CPU time of one animate() per actor, as it was (joint groups looked up by
+/// name, bind matrices inverted on every rotation, joints posed on their own)
+/// vs integer group handles and the hierarchical skeleton_pose; skeletons
+/// only, no OpenGL
+void benchmark_animate(std::string const& turtle_gltf, std::string const& shark_gltf, int frames = 100000);
+
+/// Vertices per second of the CPU linear-blend skinning of the shark (scalar,
+/// fast kernel, fast kernel on a thread_pool), and its largest difference
+/// with the shader's math; no OpenGL
+void benchmark_skinning(std::string const& shark_gltf, int repetitions = 2000);
+
+/// Update phase (animate() and pose of every actor) of a school of `actors`
+/// sharks, on 1, 2, 4 … hardware threads; no OpenGL
+void benchmark_update(std::string const& shark_gltf, int actors = 2000, int frames = 200);
+
+/// NPC updates per second (move, orient, end of life, respawn) of `npcs`
+/// roaming sharks: one shark_actor each vs npc_manager's pooled arrays on
+/// 1, 2, 4 … hardware threads; no OpenGL
+void benchmark_npc(std::string const& shark_gltf, int npcs = 10000, int frames = 600);
+
+/// Hash grid broadphase on 1k, 10k and 100k moving spheres: build and pair
+/// times (one thread, thread_pool), pairs and sphere tests per frame, vs
+/// testing all pairs; no OpenGL
+void benchmark_broadphase(int frames = 60);
@@ -28,8 +28,11 @@ struct environment_structure : environment_generic_structure
 	vec3 fog_color = vec3(0.0, 0.3, 0.5);
 	float fog_d_max = 15.0;
 
-	// number of frames in the sequence
-	int   caustic_frame_count = 240;  
+	// layers of the caustic array showing the current and next frame, and the
+	// weight of the next one (cross-fade, 0 = plain flipbook; see flipbook_stream)
+	int   caustic_layer = 0;
+	int   caustic_next_layer = 0;
+	float caustic_blend = 0.0f;
 	float caustic_fps = 5.0f;     // how many frames per second to play
 	float caustic_scale = 0.5f;
 	float caustic_intensity = 0.3f;
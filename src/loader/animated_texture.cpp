@@ -1,75 +1,270 @@
 #include <stb_image.h>
 #include "animated_texture.hpp"
+#include "asset_pipeline.hpp"
+#include "mapped_file.hpp"
+#include "pbo_ring.hpp"
+#include "texture_pack.hpp"
+#include "../utils/timing.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <memory>
+#include <vector>
 
-GLuint create_texture_array_from_sequence(
+/// base + "%0*d.{jpg|png}"
+static std::string sequence_frame_name(std::string const& base, int index,
+                                       int digits, image_format img_type)
+{
+    char filename[512];
+    snprintf(filename, sizeof(filename),
+             (base + "%0*d.%s").c_str(),
+             digits, index, (img_type == image_format::png ? "png" : "jpg"));
+    return filename;
+}
+
+std::vector<std::string> sequence_frame_names(std::string const& base, int count,
+                                              int digits, image_format img_type)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < count; ++i)
+        names.push_back(sequence_frame_name(base, i, digits, img_type));
+    return names;
+}
+
+/// resources() key of a frame sequence
+static std::string sequence_key(std::string const& base, int count, int digits, image_format img_type,
+                                bool packed)
+{
+    return resource_manager::make_key(resource_kind::texture_array, base,
+        "count=" + std::to_string(count) + "|digits=" + std::to_string(digits)
+        + (img_type == image_format::png ? "|png" : "|jpg") + (packed ? "|pack" : ""));
+}
+
+std::shared_ptr<texture_array_resource> allocate_texture_array(int W, int H, int count)
+{
+    auto array = std::make_shared<texture_array_resource>();
+    array->gpu_bytes = size_t(W) * size_t(H) * size_t(count);
+    array->layers    = count;
+    GLuint& tex = array->id;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, W, H, count, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S,     GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T,     GL_REPEAT);
+    return array;
+}
+
+std::shared_ptr<texture_array_resource> create_texture_array_from_sequence(
     std::string const& base,
     int                count,
     int                digits,
-    image_format               img_type)
+    image_format               img_type,
+    bool               use_pack)
 {
-    if (count <= 0) return 0;
+    // same streaming path, on a pipeline of our own that we wait for
+    asset_pipeline pipeline;
+    std::shared_ptr<texture_array_resource> array =
+        create_texture_array_from_sequence_async(pipeline, base, count, digits, img_type, use_pack);
+    pipeline.finish();
+    return array;
+}
 
-    // --- 1) Load first frame to get width & height ---
-    char filename[512];
-    snprintf(filename, sizeof(filename), 
-             (base + "%0*d.%s").c_str(), 
-             digits, 0, (img_type == image_format::png ? "png" : "jpg"));
+
+namespace {
+/// Upload state shared by the jobs of one sequence (touched on the GL thread only)
+struct sequence_stream {
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    std::unique_ptr<pbo_ring> ring;
+    std::vector<char>         processed;      ///< per layer: uploaded, or missing
+    int                       processed_count = 0;
+    double                    decode_ms       = 0;   ///< summed over frames (worker time)
+
+    /// Layer `i` is done (uploaded or missing): grow the ready prefix.
+    /// True once every layer is.
+    bool layer_done(texture_array_resource& array, int i)
+    {
+        processed[size_t(i)] = 1;
+        ++processed_count;
+        while (array.layers_ready < array.layers && processed[size_t(array.layers_ready)])
+            ++array.layers_ready;
+        return processed_count == array.layers;
+    }
+
+    double wall_ms() const
+    {
+        return elapsed_ms(t_start);
+    }
+};
+
+/// The array of a baked pack: one upload per layer, straight from the mapping
+std::shared_ptr<texture_array_resource> queue_pack_layers(asset_pipeline& pipeline,
+                                                          std::shared_ptr<texture_pack> pack)
+{
+    int const count = pack->layers();
+    auto array = std::make_shared<texture_array_resource>();
+    array->id        = pack->allocate_array(count);
+    array->gpu_bytes = pack->layer_bytes() * size_t(count);
+    array->layers    = count;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    auto stream = std::make_shared<sequence_stream>();
+    stream->processed.assign(size_t(count), 0);
+    for (int i = 0; i < count; ++i) {
+        pipeline.add("caustics",
+            [pack, i]() {                   // fault the pages in here, not on the GL thread
+                unsigned char const* p = pack->data(i, 0);
+                unsigned sum = 0;
+                for (size_t k = 0; k < pack->layer_bytes(); k += 4096) sum += p[k];
+                return sum;
+            },
+            [array, stream, pack, i](unsigned&) {
+                pack->upload_layer(array->id, i, i);
+                if (stream->layer_done(*array, i))
+                    std::cout << "[animated_texture] " << array->layers << " frames "
+                              << pack->width() << "x" << pack->height() << " (" << pack->levels()
+                              << " levels) uploaded from the pack in " << stream->wall_ms() << " ms"
+                              << std::endl;
+            });
+    }
+    return array;
+}
+}
+
+std::shared_ptr<texture_array_resource> create_texture_array_from_sequence_async(
+    asset_pipeline&    pipeline,
+    std::string const& base,
+    int                count,
+    int                digits,
+    image_format       img_type,
+    bool               use_pack)
+{
+    if (count <= 0) return nullptr;
+
+    std::shared_ptr<texture_pack> pack;
+    if (use_pack)
+        pack = texture_pack_open_fresh(base, sequence_frame_names(base, count, digits, img_type));
+
+    std::string const key = sequence_key(base, count, digits, img_type, pack != nullptr);
+    if (auto array = resources().find<texture_array_resource>(key))
+        return array;
+    if (pack)
+        return resources().insert(key, queue_pack_layers(pipeline, pack));
+
+    // --- 1) Header of the first frame only: width & height ---
+    std::string const first = sequence_frame_name(base, 0, digits, img_type);
     int W, H, C;
-    stbi_uc* data = stbi_load(filename, &W, &H, &C, 1);
-    if (!data) {
-        std::cerr << "[animated_texture] Failed to load “" 
-                  << filename << "”\n";
-        return 0;
+    if (!stbi_info(first.c_str(), &W, &H, &C)) {
+        std::cerr << "[animated_texture] Failed to load “"
+                  << first << "”\n";
+        return nullptr;
     }
-    stbi_image_free(data);
+    std::shared_ptr<texture_array_resource> array = allocate_texture_array(W, H, count);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
-    // --- 2) Create & bind the array texture ---
-    GLuint tex = 0;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    // --- 2) One job per frame: decode on a worker, upload through the PBO ring ---
+    auto stream = std::make_shared<sequence_stream>();
+    stream->ring = std::make_unique<pbo_ring>(size_t(W) * size_t(H), 4);
+    stream->processed.assign(size_t(count), 0);
+
+    struct frame { int w = 0, h = 0; std::shared_ptr<stbi_uc> pixels; double decode_ms = 0; };
+    for (int i = 0; i < count; ++i) {
+        std::string const filename = sequence_frame_name(base, i, digits, img_type);
+        pipeline.add("caustics",
+            [filename]() {
+                auto t0 = std::chrono::steady_clock::now();
+                frame f;
+                int c;
+                f.pixels.reset(stbi_load(filename.c_str(), &f.w, &f.h, &c, 1), stbi_image_free);
+                f.decode_ms = elapsed_ms(t0);
+                return f;
+            },
+            [array, stream, i, W, H, count, filename](frame& f) {
+                if (!f.pixels || f.w != W || f.h != H)
+                    std::cerr << "[animated_texture] Missing “"
+                              << filename << "” - skipping\n";
+                else
+                    stream->ring->upload_layer(array->id, i, W, H, GL_RED, f.pixels.get(),
+                                               size_t(W) * size_t(H));
 
-    // Allocate one level, single channel (R8)
-    glTexImage3D(GL_TEXTURE_2D_ARRAY,
-                 0,          // mip level
-                 GL_R8,      // internal format
-                 W, H, count,// width, height, layers
-                 0,          // border
-                 GL_RED,     // format of incoming data
-                 GL_UNSIGNED_BYTE,
-                 nullptr);   // no data yet
-
-    // --- 3) Fill each layer ---
-    for(int i = 0; i < count; ++i) {
-        snprintf(filename, sizeof(filename),
-                 (base + "%0*d.%s").c_str(),
-                 digits, i, (img_type == image_format::png ? "png" : "jpg"));
-
-        int w2, h2, c2;
-        stbi_uc* layer = stbi_load(filename, &w2, &h2, &c2, 1);
-        if (!layer) {
-            std::cerr << "[animated_texture] Missing “" 
-                      << filename << "” - skipping\n";
-            continue;
-        }
-
-        // upload into layer i
-        glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
-                        0,      // mip level
-                        0, 0, i,// xoffset, yoffset, layer
-                        w2, h2, 1,
-                        GL_RED, GL_UNSIGNED_BYTE,
-                        layer);
-
-        stbi_image_free(layer);
+                // layers become visible in order: [0, layers_ready)
+                stream->decode_ms += f.decode_ms;
+                if (stream->layer_done(*array, i)) {
+                    double const wall_ms = stream->wall_ms();
+                    std::cout << "[animated_texture] " << count << " frames " << W << "x" << H
+                              << " streamed in " << wall_ms << " ms: "
+                              << count / (wall_ms * 1e-3) << " frames/s ("
+                              << count / (stream->decode_ms * 1e-3) << " frames/s per worker), "
+                              << stream->ring->stalls() << "/" << stream->ring->uploads()
+                              << " PBO uploads stalled" << std::endl;
+                    stream->ring.reset();       // GL thread: free the PBOs now
+                }
+            });
     }
+    return resources().insert(key, array);
+}
 
-    // --- 4) Set filtering/wrap ---
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S,     GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T,     GL_REPEAT);
 
-    return tex;
-}
\ No newline at end of file
+std::unique_ptr<flipbook_stream> create_flipbook_stream_async(
+    asset_pipeline&    pipeline,
+    std::string const& base,
+    int                count,
+    size_t             budget_bytes,
+    int                decimation,
+    int                digits,
+    image_format       img_type)
+{
+    if (count <= 0) return nullptr;
+    decimation = std::max(1, decimation);
+    std::vector<std::string> frames = sequence_frame_names(base, count, digits, img_type);
+
+    // baked: every frame is already in the mapping, ready to upload
+    if (auto pack = texture_pack_open_fresh(base, frames)) {
+        auto stream = std::make_unique<flipbook_stream>(sequence_key(base, count, digits, img_type, true),
+                                                        pack, budget_bytes);
+        stream->set_decimation(decimation);
+        std::cout << "[animated_texture] " << stream->played_count() << " of " << count << " frames "
+                  << pack->width() << "x" << pack->height()
+                  << " streamed from " << texture_pack_path(base) << " through a ring of "
+                  << stream->ring_size() << " layers (" << stream->gpu_bytes() / 1024 << " KiB of "
+                  << pack->layer_bytes() * size_t(count) / 1024 << " KiB)" << std::endl;
+        return stream;
+    }
+
+    std::string const first = sequence_frame_name(base, 0, digits, img_type);
+    int W, H, C;
+    if (!stbi_info(first.c_str(), &W, &H, &C)) {
+        std::cerr << "[animated_texture] Failed to load “"
+                  << first << "”\n";
+        return nullptr;
+    }
+    auto stream = std::make_unique<flipbook_stream>(sequence_key(base, count, digits, img_type, false),
+                                                    W, H, frames, budget_bytes);
+    stream->set_decimation(decimation);
+
+    // the workers only read the played files: frames are decoded when played
+    flipbook_stream* target = stream.get();
+    for (int i = 0; i < count; i += decimation) {
+        std::string const& filename = frames[size_t(i)];
+        pipeline.add("caustics",
+            [filename]() {
+                mapped_file file(filename);
+                return std::vector<unsigned char>(file.data(), file.data() + file.size());
+            },
+            [target, i, filename](std::vector<unsigned char>& bytes) {
+                if (bytes.empty())
+                    std::cerr << "[animated_texture] Missing “"
+                              << filename << "” - skipping\n";
+                else
+                    target->set_frame(i, std::move(bytes));
+            });
+    }
+    std::cout << "[animated_texture] " << stream->played_count() << " of " << count << " frames "
+              << W << "x" << H << " streamed through a ring of " << stream->ring_size() << " layers ("
+              << stream->gpu_bytes() / 1024 << " KiB of " << size_t(W) * size_t(H) * size_t(count) / 1024
+              << " KiB)" << std::endl;
+    return stream;
+}
@@ -1,21 +1,72 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 #include "cgp/cgp.hpp"
+#include "resource_manager.hpp"
+#include "flipbook_stream.hpp"
+
+struct asset_pipeline;
 
 enum class image_format { jpg, png };
 
 /// Load `count` frames named
 ///    base + "%0*d.{jpg|png}"
-/// into a single GL_TEXTURE_2D_ARRAY.
+/// into a single GL_TEXTURE_2D_ARRAY: the asynchronous version below, run to
+/// completion on a pipeline of its own (frames decoded on every core).
+/// A fresh "<base>.texpack" (texture_pack_bake) is preferred: its layers
+/// come with their mip chain and need no decoding.
 /// 
 /// @param base      Path + prefix, e.g. "assets/caustics/frame_"
 /// @param count     Number of frames (0..count-1)
 /// @param digits    Zero–padding digits (usually 4)
 /// @param as_png    true = ".png", false = ".jpg"
-/// @returns         GL handle, or 0 on error
-GLuint create_texture_array_from_sequence(
+/// @param use_pack  false: always decode the frames (benchmarks)
+/// @returns         the array (shared through resources()), or nullptr on error
+std::shared_ptr<texture_array_resource> create_texture_array_from_sequence(
+    std::string const& base,
+    int                count,
+    int                digits  = 4,
+    image_format               img_type  = image_format::jpg,
+    bool               use_pack = true);
+
+/// Same as create_texture_array_from_sequence, but only the first frame's
+/// header is read here: the array is allocated at once, the frames are
+/// decoded on `pipeline`'s workers and each layer is uploaded through a ring
+/// of pixel buffer objects when it is pumped, so the transfer overlaps the
+/// decoding of the next frames. The array is usable right away:
+/// `layers_ready` counts the leading layers already uploaded. Nothing is
+/// queued if the array is already resident. From a pack, the workers only
+/// fault the mapped pages in and each layer is uploaded from the mapping.
+/// @returns         the array (shared through resources()), or nullptr on error
+std::shared_ptr<texture_array_resource> create_texture_array_from_sequence_async(
+    asset_pipeline&    pipeline,
     std::string const& base,
     int                count,
     int                digits  = 4,
-    image_format               img_type  = image_format::jpg);
\ No newline at end of file
+    image_format       img_type = image_format::jpg,
+    bool               use_pack = true);
+
+/// Streaming mode: the frames are only read from disk on `pipeline` and kept
+/// encoded in memory (or mapped from a fresh pack, read as they are played);
+/// `budget_bytes` of GPU memory hold the upcoming frames (see flipbook_stream).
+/// The stream must outlive `pipeline`'s pending jobs.
+/// @param decimation  play (and preload) every decimation-th frame only
+/// @returns         the stream, or nullptr on error
+std::unique_ptr<flipbook_stream> create_flipbook_stream_async(
+    asset_pipeline&    pipeline,
+    std::string const& base,
+    int                count,
+    size_t             budget_bytes,
+    int                decimation = 1,
+    int                digits  = 4,
+    image_format       img_type = image_format::jpg);
+
+/// base + "%0*d.{jpg|png}" for every frame
+std::vector<std::string> sequence_frame_names(std::string const& base, int count,
+                                              int digits = 4, image_format img_type = image_format::jpg);
+
+/// W x H x count single channel (R8) array, linear filtering, repeat wrap;
+/// left bound to GL_TEXTURE_2D_ARRAY
+std::shared_ptr<texture_array_resource> allocate_texture_array(int W, int H, int count);
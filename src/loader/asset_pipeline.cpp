@@ -0,0 +1,149 @@
+#include "asset_pipeline.hpp"
+#include "cgp/cgp.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+asset_pipeline::asset_pipeline(unsigned worker_count)
+    : t_start(clock::now()), workers(worker_count)
+{
+}
+
+size_t asset_pipeline::register_job(std::string const& asset)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ++jobs_total;
+    t_done_ms = -1;
+
+    auto it = std::find_if(assets.begin(), assets.end(),
+                           [&](asset_stats const& s) { return s.name == asset; });
+    if (it == assets.end()) {
+        assets.push_back({});
+        assets.back().name = asset;
+        it = assets.end() - 1;
+    }
+    ++it->jobs;
+    return size_t(it - assets.begin());
+}
+
+void asset_pipeline::push_upload(pending_upload&& p)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploads.push_back(std::move(p));
+    }
+    upload_ready.notify_one();
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  GL thread                                                                 */
+/* -------------------------------------------------------------------------- */
+void asset_pipeline::pump(double budget_ms)
+{
+    clock::time_point const t0 = clock::now();
+    do {
+        pending_upload p;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (uploads.empty()) return;
+            p = std::move(uploads.front());
+            uploads.pop_front();
+        }
+        if (p.error)
+            std::rethrow_exception(p.error);
+
+        clock::time_point const t_upload = clock::now();
+        p.upload();
+        double const upload_ms = elapsed_ms(t_upload);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        asset_stats& s = assets[p.asset];
+        s.decode_ms += p.decode_ms;
+        s.upload_ms += upload_ms;
+        ++s.uploaded;
+        ++jobs_uploaded;
+        if (s.uploaded == s.jobs)
+            s.ready_ms = elapsed_ms(t_start);
+        if (jobs_uploaded == jobs_total)
+            t_done_ms = elapsed_ms(t_start);
+    } while (elapsed_ms(t0) < budget_ms);
+}
+
+void asset_pipeline::finish()
+{
+    while (!done()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            upload_ready.wait(lock, [this] { return !uploads.empty(); });
+        }
+        pump(1e30);
+    }
+}
+
+bool asset_pipeline::done() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs_uploaded == jobs_total;
+}
+
+bool asset_pipeline::done(std::string const& asset) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (asset_stats const& s : assets)
+        if (s.name == asset)
+            return s.uploaded == s.jobs;
+    return true;
+}
+
+float asset_pipeline::progress() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs_total == 0 ? 1.0f : float(jobs_uploaded) / float(jobs_total);
+}
+
+double asset_pipeline::wall_ms() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return t_done_ms >= 0 ? t_done_ms : elapsed_ms(t_start);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Report                                                                    */
+/* -------------------------------------------------------------------------- */
+void asset_pipeline::print_report() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    double decode_total = 0, upload_total = 0;
+    std::streamsize const precision = std::cout.precision();
+    std::cout << "[asset_pipeline] " << jobs_uploaded << "/" << jobs_total << " jobs on "
+              << workers.size() << " worker(s)\n"
+              << std::fixed << std::setprecision(1)
+              << "    asset            jobs   decode ms   upload ms    ready at ms\n";
+    for (asset_stats const& s : assets) {
+        std::cout << "    " << std::left << std::setw(16) << s.name << std::right
+                  << std::setw(5)  << s.jobs
+                  << std::setw(12) << s.decode_ms
+                  << std::setw(12) << s.upload_ms
+                  << std::setw(15) << s.ready_ms << "\n";
+        decode_total += s.decode_ms;
+        upload_total += s.upload_ms;
+    }
+    std::cout << "    serial sum : " << decode_total + upload_total << " ms\n"
+              << "    wall time  : " << (t_done_ms >= 0 ? t_done_ms : elapsed_ms(t_start)) << " ms"
+              << std::defaultfloat << std::setprecision(precision) << std::endl;
+}
+
+void asset_pipeline::display_gui() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    float const fraction = jobs_total == 0 ? 1.0f : float(jobs_uploaded) / float(jobs_total);
+    ImGui::Text("Loading assets ...");
+    ImGui::ProgressBar(fraction);
+    for (asset_stats const& s : assets)
+        ImGui::Text("%-12s %4d / %d", s.name.c_str(), s.uploaded, s.jobs);
+}
@@ -0,0 +1,101 @@
+#pragma once
+// asset_pipeline.hpp
+// Asynchronous asset loading in two stages:
+//   - decode: file I/O, glTF parsing, image decoding - runs on a thread_pool
+//   - upload: every OpenGL call - queued, then run on the context thread by pump()
+// Jobs belong to a named asset ("turtle", "caustics", ...); decode/upload
+// times are accumulated per asset for the startup report.
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../utils/thread_pool.hpp"
+#include "../utils/timing.hpp"
+
+struct asset_pipeline {
+    explicit asset_pipeline(unsigned worker_count = 0);
+
+    /**
+     * Queue one job of `asset`. `decode()` runs on a worker and must not touch
+     * OpenGL; its result is then passed to `upload` on the thread calling pump().
+     */
+    template <typename Decode, typename Upload>
+    void add(std::string const& asset, Decode decode, Upload upload);
+
+    /// Run ready uploads until `budget_ms` is spent (at least one if any is ready).
+    /// A decode or upload exception is rethrown here, on the calling thread.
+    void pump(double budget_ms = 8.0);
+    /// pump() until every queued job is uploaded
+    void finish();
+
+    bool   done()     const;
+    bool   done(std::string const& asset) const;   ///< every job of `asset` uploaded
+    float  progress() const;      ///< uploaded jobs / queued jobs
+    double wall_ms()  const;      ///< since construction, frozen when done
+
+    void print_report() const;    ///< per-asset timings on std::cout
+    void display_gui()  const;    ///< ImGui progress bar and per-asset state
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct asset_stats {
+        std::string name;
+        int    jobs      = 0;
+        int    uploaded  = 0;
+        double decode_ms = 0;     ///< summed over jobs (worker time)
+        double upload_ms = 0;     ///< GL thread time
+        double ready_ms  = 0;     ///< wall time when the last job was uploaded
+    };
+    struct pending_upload {
+        size_t                asset;
+        double                decode_ms;
+        std::function<void()> upload;
+        std::exception_ptr    error;
+    };
+
+    size_t register_job(std::string const& asset);
+    void   push_upload(pending_upload&& p);
+
+    clock::time_point          t_start;
+    double                     t_done_ms = -1;
+
+    mutable std::mutex         mutex;
+    std::condition_variable    upload_ready;
+    std::deque<pending_upload> uploads;
+    std::vector<asset_stats>   assets;
+    int                        jobs_total    = 0;
+    int                        jobs_uploaded = 0;
+
+    thread_pool                workers;   // last member: joined before the rest is destroyed
+};
+
+
+template <typename Decode, typename Upload>
+void asset_pipeline::add(std::string const& asset, Decode decode, Upload upload)
+{
+    using value_type = std::decay_t<decltype(decode())>;
+    size_t const id = register_job(asset);
+
+    workers.submit([this, id, decode, upload]() {
+        clock::time_point const t0 = clock::now();
+        pending_upload p{ id, 0.0, {}, nullptr };
+        try {
+            auto value  = std::make_shared<value_type>(decode());
+            p.upload    = [value, upload]() { upload(*value); };
+        }
+        catch (...) {
+            p.error = std::current_exception();
+        }
+        p.decode_ms = elapsed_ms(t0);
+        push_upload(std::move(p));
+    });
+}
@@ -0,0 +1,120 @@
+#include "bone_palette.hpp"
+#include "gltf_loader.hpp"
+#include "resource_manager.hpp"
+
+#include <cmath>
+
+char const* skinning_defines(skinning_mode mode)
+{
+    switch (mode) {
+    case skinning_mode::affine:          return "#define SKINNING_AFFINE\n";
+    case skinning_mode::dual_quaternion: return "#define SKINNING_DUAL_QUATERNION\n";
+    default:                             return "";
+    }
+}
+
+char const* skinning_name(skinning_mode mode)
+{
+    switch (mode) {
+    case skinning_mode::affine:          return "3x4 affine";
+    case skinning_mode::dual_quaternion: return "dual quaternion";
+    default:                             return "4x4 matrix";
+    }
+}
+
+
+void append_skinning_texels(std::vector<float>& data, cgp::mat4 const* bones, size_t count, skinning_mode mode)
+{
+    for (size_t j = 0; j < count; ++j) {
+        cgp::mat4 const& M = bones[j];   // row-major
+        switch (mode) {
+        case skinning_mode::matrix:      // columns, as the shader's mat4 constructor takes them
+            for (int col = 0; col < 4; ++col)
+                for (int row = 0; row < 4; ++row)
+                    data.push_back(M(row, col));
+            break;
+        case skinning_mode::affine:      // the last row is (0, 0, 0, 1)
+            for (int row = 0; row < 3; ++row)
+                for (int col = 0; col < 4; ++col)
+                    data.push_back(M(row, col));
+            break;
+        case skinning_mode::dual_quaternion: {
+            float r[3][3];
+            for (int col = 0; col < 3; ++col) {
+                float const s = std::sqrt(M(0, col)*M(0, col) + M(1, col)*M(1, col) + M(2, col)*M(2, col));
+                for (int row = 0; row < 3; ++row)
+                    r[row][col] = s > 0 ? M(row, col) / s : float(row == col);
+            }
+            cgp::vec4 const q = gltf_rotation_quaternion(r);
+            cgp::vec3 const t = { M(0, 3), M(1, 3), M(2, 3) };
+            // dual part: 0.5 * (t, 0) * q
+            float const d[4] = { 0.5f * ( t.x*q.w + t.y*q.z - t.z*q.y),
+                                 0.5f * (-t.x*q.z + t.y*q.w + t.z*q.x),
+                                 0.5f * ( t.x*q.y - t.y*q.x + t.z*q.w),
+                                -0.5f * ( t.x*q.x + t.y*q.y + t.z*q.z) };
+            data.insert(data.end(), { q.x, q.y, q.z, q.w, d[0], d[1], d[2], d[3] });
+            break;
+        }
+        }
+    }
+}
+
+
+bone_palette::bone_palette()
+{
+    glGenBuffers(1, &buffer);
+    glGenTextures(1, &tex);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);   // follows the buffer's storage
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+bone_palette::~bone_palette()
+{
+    if (!gl_context_alive()) return;
+    glDeleteTextures(1, &tex);
+    glDeleteBuffers(1, &buffer);
+}
+
+void bone_palette::clear()
+{
+    data.clear();   // keeps its capacity: no allocation once warm
+    bone_count = 0;
+}
+
+int bone_palette::add(cgp::mat4 const* bones, size_t count, skinning_mode mode)
+{
+    int const offset = int(texels());
+    bone_count += count;
+    append_skinning_texels(data, bones, count, mode);
+    return offset;
+}
+
+int bone_palette::add_instance(cgp::mat4 const& model, int bone_offset, float baked_phase)
+{
+    int const offset = int(texels());
+    for (int col = 0; col < 4; ++col)
+        for (int row = 0; row < 4; ++row)
+            data.push_back(model(row, col));
+    data.insert(data.end(), { float(bone_offset), baked_phase, 0.0f, 0.0f });   // exact up to 2^24 texels
+    return offset;
+}
+
+void bone_palette::upload(int unit)
+{
+    calls = 0;
+    if (!data.empty()) {
+        // a new store each frame: no wait on the draws still reading the last one
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(data.size() * sizeof(float)), data.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        stored = data.size();
+        calls += 3;
+    }
+    glActiveTexture(GL_TEXTURE0 + GLenum(unit));
+    glBindTexture(GL_TEXTURE_BUFFER, tex);
+    glActiveTexture(GL_TEXTURE0);
+    calls += 3;
+}
@@ -0,0 +1,68 @@
+#pragma once
+// bone_palette.hpp
+// Skinning transforms of every actor of the frame in one texture buffer
+// (GL_RGBA32F): each actor appends its pose with add() and draws with the
+// returned offset, upload() sends everything with a single glBufferData.
+// The shader reads them with texelFetch, so there is no fixed joint count
+// (GL_MAX_TEXTURE_BUFFER_SIZE texels, at least 65536).
+// Each actor picks the layout of its bones, with the matching variant of
+// turtle.vert.glsl (skinning_defines):
+//   - matrix          : 4 texels, the columns of the mat4
+//   - affine          : 3 texels, the rows of the 3x4 affine part
+//   - dual_quaternion : 2 texels, rotation and translation of a rigid
+//                       transform; blended without the candy-wrapper
+//                       collapse of twisted joints (scale is lost)
+// Instanced draws read their model matrix and bone offset from instance
+// records in the same buffer (add_instance: 4 texels of columns + 1 texel
+// with the offset and the phase of a baked cycle), indexed by gl_InstanceID.
+// OpenGL thread only.
+
+#include <cstddef>
+#include <vector>
+#include "cgp/cgp.hpp"
+
+enum class skinning_mode : int { matrix = 0, affine = 1, dual_quaternion = 2 };
+
+/// Texels per bone in the palette
+constexpr int skinning_texels(skinning_mode mode) { return 4 - int(mode); }
+/// Lines to insert after #version in turtle.vert.glsl (see resource_manager::shader)
+char const* skinning_defines(skinning_mode mode);
+/// "4x4 matrix", "3x4 affine", "dual quaternion"
+char const* skinning_name(skinning_mode mode);
+/// Append `count` skinning matrices to `data` in the layout of `mode`
+/// (skinning_texels(mode) RGBA texels each)
+void append_skinning_texels(std::vector<float>& data, cgp::mat4 const* bones, size_t count, skinning_mode mode);
+
+struct bone_palette {
+    bone_palette();
+    bone_palette(bone_palette const&)            = delete;
+    bone_palette& operator=(bone_palette const&) = delete;
+    ~bone_palette();
+
+    /// Start a new frame: the previous matrices are dropped
+    void clear();
+    /// Append `count` skinning matrices in the layout of `mode`; returns the
+    /// offset (in texels) to draw them with
+    int add(cgp::mat4 const* bones, size_t count, skinning_mode mode);
+    /// Append the record of one instance; consecutive records form the table
+    /// of an instanced draw. `baked_phase` >= 0: the instance is posed by the
+    /// draw's baked_animation at that phase (in periods), not by bone_offset.
+    /// Returns its offset (in texels).
+    int add_instance(cgp::mat4 const& model, int bone_offset, float baked_phase = -1.0f);
+    /// Send the frame's matrices and bind the texture buffer to `unit`
+    void upload(int unit);
+
+    GLuint texture()  const { return tex; }
+    size_t texels()   const { return data.size() / 4; }
+    size_t bones()    const { return bone_count; }
+    size_t gpu_bytes() const { return stored * sizeof(float); }
+    /// GL calls made by the last upload()
+    int    gl_calls() const { return calls; }
+
+private:
+    GLuint             buffer = 0, tex = 0;
+    std::vector<float> data;           ///< RGBA texels
+    size_t             bone_count = 0;
+    size_t             stored   = 0;   ///< floats in the buffer
+    int                calls    = 0;
+};
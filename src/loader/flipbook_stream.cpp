@@ -0,0 +1,218 @@
+#include <stb_image.h>
+#include "flipbook_stream.hpp"
+#include "animated_texture.hpp"
+#include "mapped_file.hpp"
+#include "../utils/process_memory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/// Bounds the GL time of update(): the rest waits for the next frame
+static constexpr int max_uploads_per_update = 4;
+
+
+flipbook_stream::flipbook_stream(std::string const& key_, int width_, int height_,
+                                 std::vector<std::string> files_, size_t budget_bytes)
+    : key(key_), width(width_), height(height_),
+      frame_bytes(size_t(width_) * size_t(height_)), budget(budget_bytes),
+      files(std::move(files_)), encoded(files.size())
+{
+    pbo = std::make_unique<pbo_ring>(frame_bytes, 4);
+    set_budget(budget_bytes);
+}
+
+flipbook_stream::flipbook_stream(std::string const& key_, std::shared_ptr<texture_pack> pack_,
+                                 size_t budget_bytes)
+    : key(key_), width(pack_->width()), height(pack_->height()),
+      frame_bytes(pack_->layer_bytes()), budget(budget_bytes), pack(std::move(pack_)),
+      encoded(size_t(pack->layers()))
+{
+    set_budget(budget_bytes);
+}
+
+void flipbook_stream::set_frame(int frame, std::vector<unsigned char> bytes)
+{
+    if (frame < 0 || frame >= frame_count()) return;
+    if (encoded[size_t(frame)]) encoded_total -= encoded[size_t(frame)]->size();
+    encoded_total += bytes.size();
+    encoded[size_t(frame)] = std::make_shared<std::vector<unsigned char> const>(std::move(bytes));
+}
+
+void flipbook_stream::set_budget(size_t budget_bytes)
+{
+    budget = budget_bytes;
+    resize_ring();
+}
+
+void flipbook_stream::set_decimation(int factor)
+{
+    factor = std::max(1, std::min(factor, std::max(frame_count(), 1)));
+    if (factor == decimation) return;
+    decimation = factor;
+    resize_ring();      // the resident frames stay valid, only their order changes
+}
+
+void flipbook_stream::resize_ring()
+{
+    int const n = played_count();
+    if (n == 0) return;
+    size_t const fit = frame_bytes > 0 ? budget / frame_bytes : size_t(n);
+    int const layers = int(std::min<size_t>(size_t(n), std::max<size_t>(fit, 2)));
+    if (ring && ring->layers == layers) return;
+
+    // the old ring goes with its last user; decodes still in flight are dropped
+    std::shared_ptr<texture_array_resource> array;
+    if (pack) {
+        array = std::make_shared<texture_array_resource>();
+        array->id        = pack->allocate_array(layers);
+        array->gpu_bytes = frame_bytes * size_t(layers);
+        array->layers    = layers;
+    }
+    else {
+        array = allocate_texture_array(width, height, layers);
+    }
+    ring = resources().insert(key + "|ring=" + std::to_string(layers), array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    resident.assign(size_t(layers), -1);
+    requested.assign(size_t(layers), -1);
+    ready.clear();
+    ++generation;
+    shown_layer = 0;
+}
+
+void flipbook_stream::request(int64_t at, int frame)
+{
+    std::shared_ptr<std::vector<unsigned char> const> bytes = encoded[size_t(frame)];
+    std::string const file = bytes ? std::string() : files[size_t(frame)];
+    unsigned const gen = generation;
+    decoder.submit([this, bytes, file, at, frame, gen]() {
+        decoded d{ at, frame, gen, {} };
+        mapped_file mapped;                     // not kept in memory: read it now
+        unsigned char const* data = bytes ? bytes->data() : nullptr;
+        size_t               size = bytes ? bytes->size() : 0;
+        if (!bytes && mapped.open(file)) {
+            data = mapped.data();
+            size = mapped.size();
+        }
+        int w = 0, h = 0, c = 0;
+        stbi_uc* pixels = data ? stbi_load_from_memory(data, int(size), &w, &h, &c, 1) : nullptr;
+        if (pixels && w == width && h == height)
+            d.pixels.assign(pixels, pixels + frame_bytes);
+        stbi_image_free(pixels);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back(std::move(d));
+    });
+}
+
+void flipbook_stream::upload(decoded const& d)
+{
+    size_t const slot = size_t(d.position % ring->layers);
+    if (d.pixels.empty()) {   // stays requested: not retried
+        std::cerr << "[flipbook_stream] failed to decode frame " << d.frame << " of " << key << "\n";
+        return;
+    }
+    pbo->upload_layer(ring->id, int(slot), width, height, GL_RED, d.pixels.data(), frame_bytes);
+    resident[slot]  = d.frame;
+    requested[slot] = -1;
+}
+
+void flipbook_stream::update(float time, float fps)
+{
+    int const n = played_count();
+    if (n == 0 || !ring) return;
+    int const layers = ring->layers;
+    auto source = [this, n](int64_t q) { return int(q % n) * decimation; };
+
+    double const t = std::max(0.0, double(time) * double(fps) / decimation);
+    int64_t const p = int64_t(std::floor(t));
+    bool const moved = p != position;
+    position = p;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (decoded& d : finished)
+            ready.push_back(std::move(d));
+        finished.clear();
+    }
+
+    // upload the decoded frames still ahead, the nearest first
+    std::sort(ready.begin(), ready.end(),
+              [](decoded const& a, decoded const& b) { return a.position < b.position; });
+    int    uploaded = 0;
+    size_t kept     = 0;
+    for (decoded& d : ready) {
+        int& wanted = requested[size_t(d.position % layers)];
+        if (d.generation != generation || wanted != d.frame)
+            continue;                                   // slot reassigned meanwhile
+        if (d.position < p || d.position >= p + layers) {
+            wanted = -1;                                // window moved past it
+            continue;
+        }
+        if (uploaded == max_uploads_per_update) {
+            ready[kept++] = std::move(d);
+            continue;
+        }
+        upload(d);
+        ++uploaded;
+    }
+    ready.resize(kept);
+
+    // decode the rest of the window [p, p + layers), or upload it from the pack
+    for (int64_t q = p; q < p + layers; ++q) {
+        int const    frame = source(q);
+        size_t const slot  = size_t(q % layers);
+        if (resident[slot] == frame || requested[slot] == frame || !available(frame))
+            continue;
+        if (pack) {
+            if (uploaded == max_uploads_per_update) break;
+            pack->upload_layer(ring->id, int(slot), frame);
+            resident[slot] = frame;
+            ++uploaded;
+            continue;
+        }
+        requested[slot] = frame;
+        request(q, frame);
+    }
+
+    int const    current = source(p);
+    size_t const slot    = size_t(p % layers);
+    if (resident[slot] == current) {
+        shown_layer = int(slot);
+        shown_frame = current;
+    }
+    else if (moved && available(current)) {
+        ++late_count;
+    }
+
+    // cross-fade towards the next played frame, if it is there
+    size_t const next = size_t((p + 1) % layers);
+    if (blend && shown_layer == int(slot) && resident[next] == source(p + 1)) {
+        next_layer_   = int(next);
+        blend_weight_ = float(t - double(p));
+    }
+    else {
+        next_layer_   = shown_layer;
+        blend_weight_ = 0.0f;
+    }
+}
+
+void flipbook_stream::display_gui()
+{
+    ImGui::Text("Caustics: frame %3d / %d (%d played), ring of %d layers", shown_frame, frame_count(),
+                played_count(), ring_size());
+    ImGui::Text("  %.2f MiB GPU, %.2f MiB %s, %zu late frames", to_mib(gpu_bytes()),
+                to_mib(encoded_bytes()), pack ? "mapped pack" : "encoded in RAM", late_frames());
+
+    float budget_mib = float(to_mib(budget));
+    float const all_mib = float(to_mib(frame_bytes * size_t(frame_count())));
+    if (ImGui::SliderFloat("Caustic budget (MiB)", &budget_mib, float(to_mib(2 * frame_bytes)), all_mib))
+        set_budget(size_t(double(budget_mib) * 1024.0 * 1024.0));
+    int factor = decimation;
+    if (ImGui::SliderInt("Caustic decimation", &factor, 1, 8))
+        set_decimation(factor);
+    bool cross_fade = blend;
+    if (ImGui::Checkbox("Blend caustic frames", &cross_fade))
+        set_blend(cross_fade);
+}
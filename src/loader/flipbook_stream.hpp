@@ -0,0 +1,121 @@
+#pragma once
+// flipbook_stream.hpp
+// Animated texture played one frame at a time with a bounded GPU footprint:
+// only a ring of the upcoming frames is resident in a GL_TEXTURE_2D_ARRAY,
+// the whole sequence stays encoded (jpg / png bytes) in system memory, or
+// mapped from a texture_pack (mip chains, uploaded without decoding).
+//   - with a decimation factor d only frames 0, d, 2d ... are played, each
+//     for d frame durations; blending cross-fades from one to the next so
+//     the motion stays smooth with d times fewer frames
+//   - playback position p = floor(time * fps / d) shows played frame
+//     p % played_count from layer p % ring_size, so the window
+//     [p, p + ring_size) always maps to distinct layers
+//   - the frames of the window are decoded on two workers and uploaded
+//     through a pbo_ring, a few per update(); pack frames are uploaded
+//     straight from the mapping
+//   - ring_size follows the texture memory budget; when every played frame
+//     fits it is the whole sequence and nothing is uploaded twice
+// OpenGL thread only, except for the decoding done internally.
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cgp/cgp.hpp"
+#include "pbo_ring.hpp"
+#include "texture_pack.hpp"
+#include "resource_manager.hpp"
+#include "../utils/thread_pool.hpp"
+
+struct flipbook_stream {
+    /// `key`: resources() key of the sequence; the ring is registered under key + "|ring=N".
+    /// Frames not given to set_frame are read from `files` when played.
+    flipbook_stream(std::string const& key, int width, int height,
+                    std::vector<std::string> files, size_t budget_bytes);
+    /// Frames of a baked pack: every frame is available at once
+    flipbook_stream(std::string const& key, std::shared_ptr<texture_pack> pack, size_t budget_bytes);
+    flipbook_stream(flipbook_stream const&)            = delete;
+    flipbook_stream& operator=(flipbook_stream const&) = delete;
+
+    /// Encoded file contents of `frame`, kept in memory
+    void set_frame(int frame, std::vector<unsigned char> encoded);
+    /// Resize the ring to the largest one under `budget_bytes` (at least 2 layers)
+    void set_budget(size_t budget_bytes);
+    /// Play every `factor`-th frame only (1: all of them)
+    void set_decimation(int factor);
+    /// Cross-fade between consecutive played frames (needs both resident)
+    void set_blend(bool enabled) { blend = enabled; }
+
+    /// Once per rendered frame: upload what was decoded, request the window
+    /// starting at `time`, pick the layers to sample (the latest resident
+    /// frame if the current one is late).
+    void update(float time, float fps);
+
+    GLuint texture()      const { return ring ? ring->id : 0; }
+    int    layer()        const { return shown_layer; }
+    int    next_layer()   const { return next_layer_; }
+    float  blend_weight() const { return blend_weight_; }   ///< of next_layer(), 0 without blending
+    int    frame()        const { return shown_frame; }
+    int    frame_count()  const { return int(encoded.size()); }
+    int    played_count() const { return (frame_count() + decimation - 1) / decimation; }
+    int    decimation_factor() const { return decimation; }
+    bool   blending()     const { return blend; }
+    bool   from_pack()    const { return pack != nullptr; }
+    int    ring_size()    const { return ring ? ring->layers : 0; }
+    size_t gpu_bytes()    const { return ring ? ring->gpu_bytes : 0; }
+    /// Encoded frames in memory, or the size of the mapped pack
+    size_t encoded_bytes() const { return pack ? pack->file_bytes() : encoded_total; }
+    /// Playback positions whose frame was not resident in time
+    size_t late_frames() const { return late_count; }
+
+    /// Frame, ring size, memory; budget, decimation and blending controls
+    void display_gui();
+
+private:
+    struct decoded {
+        int64_t                    position;
+        int                        frame;
+        unsigned                   generation;
+        std::vector<unsigned char> pixels;   ///< empty if the decoding failed
+    };
+
+    bool available(int frame) const
+    {
+        return pack || encoded[size_t(frame)] || size_t(frame) < files.size();
+    }
+    void resize_ring();
+    void request(int64_t position, int frame);
+    void upload(decoded const& d);
+
+    std::string key;
+    int         width, height;
+    size_t      frame_bytes;
+    size_t      budget;
+    int         decimation = 1;
+    bool        blend      = false;
+    std::shared_ptr<texture_pack> pack;
+    std::vector<std::string>      files;
+
+    std::vector<std::shared_ptr<std::vector<unsigned char> const>> encoded;
+    size_t      encoded_total = 0;
+
+    std::shared_ptr<texture_array_resource> ring;
+    std::vector<int> resident;    ///< per layer: frame uploaded there, -1 if none
+    std::vector<int> requested;   ///< per layer: frame being decoded for it, -1 if none
+    unsigned         generation = 0;   ///< bumped with the ring: stale decodes are dropped
+    std::vector<decoded> ready;   ///< decoded, waiting for their upload
+    std::unique_ptr<pbo_ring> pbo;
+
+    int64_t position      = -1;
+    int     shown_layer   = 0;
+    int     next_layer_   = 0;
+    float   blend_weight_ = 0;
+    int     shown_frame   = 0;
+    size_t  late_count    = 0;
+
+    std::mutex           mutex;
+    std::vector<decoded> finished;   ///< filled by the workers
+
+    thread_pool decoder{ 2 };   // last member: joined before the rest is destroyed
+};
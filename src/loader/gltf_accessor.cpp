@@ -0,0 +1,508 @@
+#include "gltf_accessor.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ACCESSOR_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ACCESSOR_SSE2
+#endif
+
+static_assert(sizeof(cgp::vec2)  == 2*sizeof(float),    "vec2 must be tightly packed");
+static_assert(sizeof(cgp::vec3)  == 3*sizeof(float),    "vec3 must be tightly packed");
+static_assert(sizeof(cgp::vec4)  == 4*sizeof(float),    "vec4 must be tightly packed");
+static_assert(sizeof(cgp::uint3) == 3*sizeof(uint32_t), "uint3 must be tightly packed");
+static_assert(sizeof(cgp::uint4) == 4*sizeof(uint32_t), "uint4 must be tightly packed");
+
+namespace {
+
+/* -------------------------------------------------------------------------- */
+/*  Where the elements of an accessor live                                    */
+/* -------------------------------------------------------------------------- */
+struct accessor_layout {
+    const unsigned char* base = nullptr;   ///< first element, nullptr = no bufferView (all zero)
+    size_t count          = 0;
+    int    component_type = 0;
+    int    component_size = 0;
+    int    components     = 0;             ///< per element (16 for MAT4)
+    int    rows           = 0;             ///< components per column (= components for vectors)
+    size_t column_stride  = 0;             ///< bytes between matrix columns (padded to 4)
+    size_t element_size   = 0;
+    size_t stride         = 0;             ///< bytes between two elements
+    bool   normalized     = false;
+
+    bool columns_packed() const { return column_stride == size_t(rows) * component_size; }
+    bool is_packed()      const { return stride == element_size && columns_packed(); }
+};
+
+int rows_of_type(int type, int components)
+{
+    switch (type) {
+    case TINYGLTF_TYPE_MAT2: return 2;
+    case TINYGLTF_TYPE_MAT3: return 3;
+    case TINYGLTF_TYPE_MAT4: return 4;
+    default:                 return components;
+    }
+}
+
+accessor_layout make_layout(const tinygltf::Model& model, int view_index, size_t byte_offset,
+                            size_t count, int component_type, int type, bool normalized,
+                            bool use_view_stride)
+{
+    accessor_layout L;
+    L.count          = count;
+    L.component_type = component_type;
+    L.component_size = tinygltf::GetComponentSizeInBytes(uint32_t(component_type));
+    L.components     = tinygltf::GetNumComponentsInType(uint32_t(type));
+    L.normalized     = normalized;
+    if (L.component_size <= 0 || L.components <= 0)
+        throw std::runtime_error("glTF accessor has an unsupported type (component type "
+                                 + std::to_string(component_type) + ")");
+
+    L.rows = rows_of_type(type, L.components);
+    const int columns = L.components / L.rows;
+    L.column_stride = size_t(L.rows) * L.component_size;
+    if (columns > 1)                                   // matrix columns start on 4 bytes
+        L.column_stride = (L.column_stride + 3) & ~size_t(3);
+    L.element_size = L.column_stride * columns;
+    L.stride       = L.element_size;
+
+    if (view_index < 0) return L;                      // zero-initialized accessor
+
+    const auto& view = model.bufferViews.at(view_index);
+    const auto& buf  = model.buffers.at(view.buffer);
+    if (use_view_stride && view.byteStride != 0)
+        L.stride = view.byteStride;
+
+    const size_t start  = view.byteOffset + byte_offset;
+    const size_t needed = count == 0 ? 0 : L.stride * (count - 1) + L.element_size;
+    if (start > buf.data.size() || needed > buf.data.size() - start)
+        throw std::runtime_error("glTF accessor reads past the end of its buffer");
+
+    L.base = buf.data.data() + start;
+    return L;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Scalar reference path                                                     */
+/* -------------------------------------------------------------------------- */
+template <typename T>
+T load(const unsigned char* p) { T v; std::memcpy(&v, p, sizeof(T)); return v; }
+
+float component_as_float(const unsigned char* p, int type, bool normalized)
+{
+    switch (type) {
+    case TINYGLTF_COMPONENT_TYPE_BYTE: {
+        float v = float(load<int8_t>(p));
+        return normalized ? std::max(v / 127.0f, -1.0f) : v;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+        float v = float(load<uint8_t>(p));
+        return normalized ? v / 255.0f : v;
+    }
+    case TINYGLTF_COMPONENT_TYPE_SHORT: {
+        float v = float(load<int16_t>(p));
+        return normalized ? std::max(v / 32767.0f, -1.0f) : v;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+        float v = float(load<uint16_t>(p));
+        return normalized ? v / 65535.0f : v;
+    }
+    case TINYGLTF_COMPONENT_TYPE_INT:          return float(load<int32_t>(p));
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: return float(load<uint32_t>(p));
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:        return load<float>(p);
+    case TINYGLTF_COMPONENT_TYPE_DOUBLE:       return float(load<double>(p));
+    default:                                   return 0.0f;
+    }
+}
+
+uint32_t component_as_uint(const unsigned char* p, int type)
+{
+    switch (type) {
+    case TINYGLTF_COMPONENT_TYPE_BYTE:           return uint32_t(std::max<int8_t>(load<int8_t>(p), 0));
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  return load<uint8_t>(p);
+    case TINYGLTF_COMPONENT_TYPE_SHORT:          return uint32_t(std::max<int16_t>(load<int16_t>(p), 0));
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: return load<uint16_t>(p);
+    case TINYGLTF_COMPONENT_TYPE_INT:            return uint32_t(std::max<int32_t>(load<int32_t>(p), 0));
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   return load<uint32_t>(p);
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:          return uint32_t(std::max(load<float>(p), 0.0f));
+    case TINYGLTF_COMPONENT_TYPE_DOUBLE:         return uint32_t(std::max(load<double>(p), 0.0));
+    default:                                     return 0;
+    }
+}
+
+const unsigned char* component_ptr(const accessor_layout& L, const unsigned char* element, int k)
+{
+    return element + (k / L.rows) * L.column_stride + (k % L.rows) * L.component_size;
+}
+
+template <typename T, typename Convert>
+void decode_scalar(const accessor_layout& L, T* dst, int dst_components, Convert convert)
+{
+    const int n = std::min(L.components, dst_components);
+    for (size_t i = 0; i < L.count; ++i) {
+        const unsigned char* e = L.base + i * L.stride;
+        T* d = dst + i * dst_components;
+        for (int k = 0; k < n; ++k)
+            d[k] = convert(component_ptr(L, e, k));
+        for (int k = n; k < dst_components; ++k)
+            d[k] = T(0);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Batch kernels: n contiguous components                                    */
+/* -------------------------------------------------------------------------- */
+void convert_u8(const unsigned char* src, float* dst, size_t n, float scale)
+{
+    size_t i = 0;
+#if defined(ACCESSOR_AVX2)
+    const __m256 s = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        __m256  f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(f, s));
+    }
+#elif defined(ACCESSOR_SSE2)
+    const __m128  s    = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i b  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(b, zero);
+        __m128i hi = _mm_unpackhi_epi8(b, zero);
+        _mm_storeu_ps(dst + i +  0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), s));
+        _mm_storeu_ps(dst + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), s));
+        _mm_storeu_ps(dst + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), s));
+        _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), s));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = float(src[i]) * scale;
+}
+
+void convert_u16(const unsigned char* src, float* dst, size_t n, float scale)
+{
+    size_t i = 0;
+#if defined(ACCESSOR_AVX2)
+    const __m256 s = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+        __m256  f = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(w));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(f, s));
+    }
+#elif defined(ACCESSOR_SSE2)
+    const __m128  s    = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+        _mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(w, zero)), s));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(w, zero)), s));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = float(load<uint16_t>(src + 2*i)) * scale;
+}
+
+/// signed input: result = max(v*scale, lowest) (lowest = -1 for normalized data)
+void convert_i8(const unsigned char* src, float* dst, size_t n, float scale, float lowest)
+{
+    size_t i = 0;
+#if defined(ACCESSOR_AVX2)
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 m = _mm256_set1_ps(lowest);
+    for (; i + 8 <= n; i += 8) {
+        __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        __m256  f = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(b));
+        _mm256_storeu_ps(dst + i, _mm256_max_ps(_mm256_mul_ps(f, s), m));
+    }
+#elif defined(ACCESSOR_SSE2)
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 m = _mm_set1_ps(lowest);
+    for (; i + 16 <= n; i += 16) {
+        __m128i b  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);   // sign-extend to 16 bits
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8);
+        __m128i q[4] = {
+            _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16),        // ... and to 32 bits
+            _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16),
+            _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16),
+            _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16) };
+        for (int k = 0; k < 4; ++k)
+            _mm_storeu_ps(dst + i + 4*k, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(q[k]), s), m));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = std::max(float(load<int8_t>(src + i)) * scale, lowest);
+}
+
+void convert_i16(const unsigned char* src, float* dst, size_t n, float scale, float lowest)
+{
+    size_t i = 0;
+#if defined(ACCESSOR_AVX2)
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 m = _mm256_set1_ps(lowest);
+    for (; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+        __m256  f = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(w));
+        _mm256_storeu_ps(dst + i, _mm256_max_ps(_mm256_mul_ps(f, s), m));
+    }
+#elif defined(ACCESSOR_SSE2)
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 m = _mm_set1_ps(lowest);
+    for (; i + 8 <= n; i += 8) {
+        __m128i w  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16);
+        _mm_storeu_ps(dst + i + 0, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(lo), s), m));
+        _mm_storeu_ps(dst + i + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(hi), s), m));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = std::max(float(load<int16_t>(src + 2*i)) * scale, lowest);
+}
+
+void widen_u8(const unsigned char* src, uint32_t* dst, size_t n)
+{
+    size_t i = 0;
+#if defined(ACCESSOR_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtepu8_epi32(b));
+    }
+#elif defined(ACCESSOR_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i b  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(b, zero);
+        __m128i hi = _mm_unpackhi_epi8(b, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i +  0), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i +  4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i +  8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = src[i];
+}
+
+void widen_u16(const unsigned char* src, uint32_t* dst, size_t n)
+{
+    size_t i = 0;
+#if defined(ACCESSOR_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtepu16_epi32(w));
+    }
+#elif defined(ACCESSOR_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 0), _mm_unpacklo_epi16(w, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(w, zero));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = load<uint16_t>(src + 2*i);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Dense decode (fast path when possible, scalar otherwise)                  */
+/* -------------------------------------------------------------------------- */
+void decode(const accessor_layout& L, float* dst, int dst_components, accessor_path path)
+{
+    if (L.base == nullptr) {
+        std::fill(dst, dst + L.count * dst_components, 0.0f);
+        return;
+    }
+
+    if (path == accessor_path::fast)
+    {
+        // whole accessor is one contiguous run of components
+        if (L.is_packed() && L.components == dst_components) {
+            const size_t n = L.count * L.components;
+            const float  lowest = L.normalized ? -1.0f : -FLT_MAX;
+            switch (L.component_type) {
+            case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                std::memcpy(dst, L.base, n * sizeof(float));
+                return;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                convert_u8(L.base, dst, n, L.normalized ? 1.0f/255.0f : 1.0f);
+                return;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                convert_u16(L.base, dst, n, L.normalized ? 1.0f/65535.0f : 1.0f);
+                return;
+            case TINYGLTF_COMPONENT_TYPE_BYTE:
+                convert_i8(L.base, dst, n, L.normalized ? 1.0f/127.0f : 1.0f, lowest);
+                return;
+            case TINYGLTF_COMPONENT_TYPE_SHORT:
+                convert_i16(L.base, dst, n, L.normalized ? 1.0f/32767.0f : 1.0f, lowest);
+                return;
+            default:
+                break;
+            }
+        }
+        // interleaved floats: one memcpy per element
+        if (L.component_type == TINYGLTF_COMPONENT_TYPE_FLOAT && L.columns_packed()) {
+            const int n = std::min(L.components, dst_components);
+            for (size_t i = 0; i < L.count; ++i) {
+                float* d = dst + i * dst_components;
+                std::memcpy(d, L.base + i * L.stride, n * sizeof(float));
+                std::fill(d + n, d + dst_components, 0.0f);
+            }
+            return;
+        }
+    }
+
+    const int  type       = L.component_type;
+    const bool normalized = L.normalized;
+    decode_scalar(L, dst, dst_components,
+        [type, normalized](const unsigned char* p) { return component_as_float(p, type, normalized); });
+}
+
+void decode(const accessor_layout& L, uint32_t* dst, int dst_components, accessor_path path)
+{
+    if (L.base == nullptr) {
+        std::fill(dst, dst + L.count * dst_components, 0u);
+        return;
+    }
+
+    if (path == accessor_path::fast && L.is_packed() && L.components == dst_components) {
+        const size_t n = L.count * L.components;
+        switch (L.component_type) {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            std::memcpy(dst, L.base, n * sizeof(uint32_t));
+            return;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            widen_u8(L.base, dst, n);
+            return;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            widen_u16(L.base, dst, n);
+            return;
+        default:
+            break;
+        }
+    }
+
+    const int type = L.component_type;
+    decode_scalar(L, dst, dst_components,
+        [type](const unsigned char* p) { return component_as_uint(p, type); });
+}
+
+/// Overwrite the elements listed by a sparse accessor
+template <typename T>
+void apply_sparse(const tinygltf::Model& model, const tinygltf::Accessor& acc,
+                  T* dst, int dst_components, accessor_path path)
+{
+    if (!acc.sparse.isSparse || acc.sparse.count <= 0) return;
+    const size_t n = size_t(acc.sparse.count);
+
+    std::vector<uint32_t> indices(n);
+    accessor_layout LI = make_layout(model, acc.sparse.indices.bufferView,
+                                     size_t(acc.sparse.indices.byteOffset), n,
+                                     acc.sparse.indices.componentType, TINYGLTF_TYPE_SCALAR,
+                                     false, false);
+    decode(LI, indices.data(), 1, path);
+
+    std::vector<T> values(n * dst_components);
+    accessor_layout LV = make_layout(model, acc.sparse.values.bufferView,
+                                     size_t(acc.sparse.values.byteOffset), n,
+                                     acc.componentType, acc.type, acc.normalized, false);
+    decode(LV, values.data(), dst_components, path);
+
+    for (size_t k = 0; k < n; ++k) {
+        if (indices[k] >= acc.count)
+            throw std::runtime_error("glTF sparse accessor index out of range");
+        std::memcpy(dst + size_t(indices[k]) * dst_components,
+                    values.data() + k * dst_components, dst_components * sizeof(T));
+    }
+}
+
+template <typename T>
+void read_accessor(const tinygltf::Model& model, int index, T* dst, int dst_components,
+                   accessor_path path)
+{
+    const tinygltf::Accessor& acc = model.accessors.at(index);
+    accessor_layout L = make_layout(model, acc.bufferView, acc.byteOffset, acc.count,
+                                    acc.componentType, acc.type, acc.normalized, true);
+    decode(L, dst, dst_components, path);
+    apply_sparse(model, acc, dst, dst_components, path);
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+/*  Public API                                                                */
+/* -------------------------------------------------------------------------- */
+void accessor_read_float(const tinygltf::Model& model, int index,
+                         float* dst, int dst_components, accessor_path path)
+{
+    read_accessor(model, index, dst, dst_components, path);
+}
+
+void accessor_read_uint(const tinygltf::Model& model, int index,
+                        uint32_t* dst, int dst_components, accessor_path path)
+{
+    read_accessor(model, index, dst, dst_components, path);
+}
+
+size_t accessor_count(const tinygltf::Model& model, int index)
+{
+    return model.accessors.at(index).count;
+}
+
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::vec2>& dst)
+{
+    dst.resize(accessor_count(model, index));
+    accessor_read_float(model, index, reinterpret_cast<float*>(dst.data.data()), 2);
+}
+
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::vec3>& dst)
+{
+    dst.resize(accessor_count(model, index));
+    accessor_read_float(model, index, reinterpret_cast<float*>(dst.data.data()), 3);
+}
+
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::vec4>& dst)
+{
+    dst.resize(accessor_count(model, index));
+    accessor_read_float(model, index, reinterpret_cast<float*>(dst.data.data()), 4);
+}
+
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::uint4>& dst)
+{
+    dst.resize(accessor_count(model, index));
+    accessor_read_uint(model, index, reinterpret_cast<uint32_t*>(dst.data.data()), 4);
+}
+
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::uint3>& dst)
+{
+    // decode the flat index list straight into the triangles, then drop
+    // a trailing incomplete triangle if any
+    const size_t n = accessor_count(model, index);
+    dst.resize((n + 2) / 3);
+    accessor_read_uint(model, index, reinterpret_cast<uint32_t*>(dst.data.data()), 1);
+    dst.resize(n / 3);
+}
+
+void accessor_read(const tinygltf::Model& model, int index, std::vector<cgp::mat4>& dst)
+{
+    const size_t n = accessor_count(model, index);
+    std::vector<float> m(16 * n);
+    accessor_read_float(model, index, m.data(), 16);
+
+    dst.resize(n);
+    for (size_t k = 0; k < n; ++k)
+        for (int col = 0; col < 4; ++col)
+            for (int row = 0; row < 4; ++row)
+                dst[k](row, col) = m[16*k + 4*col + row];   // glTF is column-major
+}
@@ -0,0 +1,49 @@
+#pragma once
+// gltf_accessor.hpp
+// Bulk decoding of glTF accessors into CGP containers.
+//
+// Handles every component type (signed/unsigned 8/16/32-bit integers and
+// floats), `normalized` integers, interleaved buffer views (byteStride),
+// matrix column padding and sparse accessors.
+//   - tightly packed data already in the destination format is memcpy'd
+//   - packed 8/16-bit data is converted in SSE2/AVX2 batches
+//   - anything else (interleaved, mismatched component count) goes through
+//     the per-element scalar path
+
+#include <cstdint>
+#include <vector>
+#include "cgp/cgp.hpp"
+#include "tiny_gltf.h"
+
+/// Which conversion kernels may be used (scalar = reference, for checks/benchmarks)
+enum class accessor_path { fast, scalar };
+
+/**
+ * Decode accessor `index` as floats, `dst_components` per element
+ * (dst must hold count*dst_components values). Normalized integers map to
+ * [0,1] / [-1,1], the others are converted as-is. Extra destination
+ * components are set to 0.
+ *
+ * @throw std::runtime_error if the accessor points outside its buffer.
+ */
+void accessor_read_float(const tinygltf::Model& model, int index,
+                         float* dst, int dst_components,
+                         accessor_path path = accessor_path::fast);
+
+/// Same as accessor_read_float, for integer data (joints, indices)
+void accessor_read_uint(const tinygltf::Model& model, int index,
+                        uint32_t* dst, int dst_components,
+                        accessor_path path = accessor_path::fast);
+
+/// Number of elements of accessor `index`
+size_t accessor_count(const tinygltf::Model& model, int index);
+
+/* ---- typed helpers (resize dst to the accessor count) ------------------- */
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::vec2>& dst);
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::vec3>& dst);
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::vec4>& dst);
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::uint4>& dst);
+/// SCALAR index accessor read as a triangle list
+void accessor_read(const tinygltf::Model& model, int index, cgp::numarray<cgp::uint3>& dst);
+/// MAT4 accessor (glTF column-major) converted to cgp::mat4
+void accessor_read(const tinygltf::Model& model, int index, std::vector<cgp::mat4>& dst);
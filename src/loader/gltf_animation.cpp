@@ -0,0 +1,312 @@
+#include "gltf_animation.hpp"
+#include "gltf_accessor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+
+/* -------------------------------------------------------------------------- */
+/*  Set                                                                       */
+/* -------------------------------------------------------------------------- */
+int gltf_animation_set::find(std::string_view name) const
+{
+    for (size_t k = 0; k < clips.size(); ++k)
+        if (name == clips[k].name) return int(k);
+    return -1;
+}
+
+size_t gltf_animation_set::key_count() const
+{
+    size_t n = 0;
+    for (gltf_animation_channel const& c : channels) n += c.key_count;
+    return n;
+}
+
+size_t gltf_animation_set::bytes() const
+{
+    return clips.size() * sizeof(gltf_animation_clip) + channels.size() * sizeof(gltf_animation_channel)
+         + times.size() * sizeof(float) + values.size() * sizeof(float) + packed.size() * sizeof(uint16_t);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Loading                                                                   */
+/* -------------------------------------------------------------------------- */
+namespace {
+
+bool parse_path(std::string const& path, gltf_channel_path& out)
+{
+    if (path == "translation") { out = gltf_channel_path::translation; return true; }
+    if (path == "rotation")    { out = gltf_channel_path::rotation;    return true; }
+    if (path == "scale")       { out = gltf_channel_path::scale;       return true; }
+    return false;   // "weights": morph targets, not supported
+}
+
+gltf_interpolation parse_interpolation(std::string const& name)
+{
+    if (name == "STEP")        return gltf_interpolation::step;
+    if (name == "CUBICSPLINE") return gltf_interpolation::cubic_spline;
+    return gltf_interpolation::linear;   // the default
+}
+
+} // namespace
+
+void gltf_load_animations(const tinygltf::Model& model, std::vector<int> const& joint_of_node,
+                          gltf_animation_set& out)
+{
+    out = gltf_animation_set();
+    std::map<int, std::pair<uint32_t, uint32_t>> times_of_accessor;   // input -> first key, count
+
+    for (const tinygltf::Animation& animation : model.animations) {
+        gltf_animation_clip clip;
+        std::strncpy(clip.name, animation.name.c_str(), sizeof(clip.name) - 1);
+        clip.first_channel = uint32_t(out.channels.size());
+        int const clip_index = int(out.clips.size());
+
+        for (const tinygltf::AnimationChannel& channel : animation.channels) {
+            gltf_channel_path path;
+            if (!parse_path(channel.target_path, path)) continue;
+            if (channel.target_node < 0 || channel.target_node >= int(joint_of_node.size())
+                || joint_of_node[size_t(channel.target_node)] < 0)
+                continue;   // not a joint of the skin
+            if (channel.sampler < 0 || channel.sampler >= int(animation.samplers.size())) continue;
+            const tinygltf::AnimationSampler& sampler = animation.samplers[size_t(channel.sampler)];
+
+            gltf_animation_channel c;
+            c.clip          = clip_index;
+            c.joint         = joint_of_node[size_t(channel.target_node)];
+            c.path          = uint8_t(path);
+            c.interpolation = uint8_t(parse_interpolation(sampler.interpolation));
+            c.components    = path == gltf_channel_path::rotation ? 4 : 3;
+
+            size_t const keys   = accessor_count(model, sampler.input);
+            size_t const values = accessor_count(model, sampler.output);
+            if (keys == 0 || values != keys * c.key_values()) {
+                std::cerr << "[gltf_animation] \"" << animation.name << "\": sampler " << channel.sampler
+                          << " has " << keys << " keys for " << values << " values, skipped" << std::endl;
+                continue;
+            }
+
+            auto shared = times_of_accessor.find(sampler.input);
+            if (shared == times_of_accessor.end()) {
+                std::vector<float> t(keys);
+                accessor_read_float(model, sampler.input, t.data(), 1);
+                if (!std::is_sorted(t.begin(), t.end())) {
+                    std::cerr << "[gltf_animation] \"" << animation.name << "\": sampler " << channel.sampler
+                              << " has decreasing key times, skipped" << std::endl;
+                    continue;
+                }
+                shared = times_of_accessor.emplace(sampler.input,
+                                                   std::make_pair(uint32_t(out.times.size()), uint32_t(keys))).first;
+                out.times.insert(out.times.end(), t.begin(), t.end());
+            }
+            c.first_key   = shared->second.first;
+            c.key_count   = shared->second.second;
+            c.first_value = uint32_t(out.values.size());
+            out.values.resize(out.values.size() + values * c.components);
+            accessor_read_float(model, sampler.output, out.values.data() + c.first_value, c.components);
+
+            clip.duration = std::max(clip.duration, out.times[c.first_key + c.key_count - 1]);
+            out.channels.push_back(c);
+        }
+
+        clip.channel_count = uint32_t(out.channels.size()) - clip.first_channel;
+        if (clip.channel_count > 0)
+            out.clips.push_back(clip);
+        else
+            std::cerr << "[gltf_animation] \"" << animation.name << "\": no channel on the skin, skipped" << std::endl;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Sampling                                                                  */
+/* -------------------------------------------------------------------------- */
+namespace {
+
+/// Key k such that times[k] <= t < times[k+1] (0 before the first key),
+/// starting from the previous one
+uint32_t seek(float const* times, uint32_t n, uint32_t cursor, float t)
+{
+    uint32_t k = cursor < n ? cursor : 0;
+    if (t >= times[k]) {
+        // playing forward: the next key or the one after
+        for (int step = 0; step < 2; ++step) {
+            if (k + 1 >= n || t < times[k + 1]) return k;
+            ++k;
+        }
+        if (k + 1 >= n || t < times[k + 1]) return k;
+    }
+    uint32_t const after = uint32_t(std::upper_bound(times, times + n, t) - times);
+    return after > 0 ? after - 1 : 0;
+}
+
+void normalize4(float q[4])
+{
+    float const l = std::sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    if (l > 0)
+        for (int i = 0; i < 4; ++i) q[i] /= l;
+}
+
+void slerp(float const a[4], float b[4], float s, float out[4])
+{
+    float d = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+    if (d < 0) {   // shortest path
+        for (int i = 0; i < 4; ++i) b[i] = -b[i];
+        d = -d;
+    }
+    float wa = 1 - s, wb = s;
+    if (d < 0.9995f) {
+        float const theta = std::acos(d), sine = std::sin(theta);
+        wa = std::sin((1 - s) * theta) / sine;
+        wb = std::sin(s * theta) / sine;
+    }
+    for (int i = 0; i < 4; ++i) out[i] = wa * a[i] + wb * b[i];
+    normalize4(out);
+}
+
+/// Linear interpolation of two keys, slerp for rotations
+void blend(bool rotation, float const a[4], float b[4], float s, int components, float out[4])
+{
+    if (rotation)
+        slerp(a, b, s, out);
+    else
+        for (int i = 0; i < components; ++i) out[i] = a[i] + s * (b[i] - a[i]);
+}
+
+} // namespace
+
+void gltf_sample_channel(gltf_animation_set const& set, gltf_animation_channel const& c,
+                         uint32_t& cursor, float t, float out[4])
+{
+    float const* times = set.times.data() + c.first_key;
+    uint32_t const n   = c.key_count;
+    int const m        = c.components;
+    bool const rotation = c.path == uint8_t(gltf_channel_path::rotation);
+    bool const cubic    = c.interpolation == uint8_t(gltf_interpolation::cubic_spline);
+    size_t const middle = cubic ? 1 : 0;   // value slot of a key (after the in-tangent)
+    uint32_t const per  = c.key_values();
+
+    uint32_t const k = seek(times, n, cursor, t);
+    cursor = k;
+    if (k + 1 >= n || t <= times[k] || c.interpolation == uint8_t(gltf_interpolation::step)) {
+        for (int i = 0; i < m; ++i) out[i] = set.value(c, k * per + middle, i);
+        if (rotation) normalize4(out);
+        return;
+    }
+
+    float const dt = times[k + 1] - times[k];
+    float const s  = (t - times[k]) / dt;
+    if (cubic) {
+        // Hermite spline: p_k, dt * out-tangent_k, p_k+1, dt * in-tangent_k+1
+        float const s2 = s * s, s3 = s2 * s;
+        float const h00 = 2*s3 - 3*s2 + 1, h10 = s3 - 2*s2 + s, h01 = -2*s3 + 3*s2, h11 = s3 - s2;
+        for (int i = 0; i < m; ++i)
+            out[i] = h00 * set.value(c, 3*k + 1, i) + h10 * dt * set.value(c, 3*k + 2, i)
+                   + h01 * set.value(c, 3*(k + 1) + 1, i) + h11 * dt * set.value(c, 3*(k + 1), i);
+        if (rotation) normalize4(out);
+        return;
+    }
+
+    float a[4], b[4];
+    for (int i = 0; i < m; ++i) {
+        a[i] = set.value(c, k, i);
+        b[i] = set.value(c, k + 1, i);
+    }
+    blend(rotation, a, b, s, m, out);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Compact storage                                                           */
+/* -------------------------------------------------------------------------- */
+void gltf_reduce_animations(gltf_animation_set& set, float tolerance)
+{
+    gltf_animation_set reduced;
+    reduced.clips  = set.clips;
+    reduced.packed = set.packed;
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> kept_times;   // unchanged ranges stay shared
+
+    for (gltf_animation_channel c : set.channels) {
+        float const* times = set.times.data() + c.first_key;
+        std::vector<uint32_t> keep;
+        bool const reducible = !c.quantized && c.interpolation != uint8_t(gltf_interpolation::cubic_spline)
+                            && c.key_count > 2;
+        if (!reducible) {
+            for (uint32_t k = 0; k < c.key_count; ++k) keep.push_back(k);
+        } else {
+            // greedy: extend the segment from the last kept key while it
+            // reproduces every key it skips
+            bool const rotation = c.path == uint8_t(gltf_channel_path::rotation);
+            bool const step     = c.interpolation == uint8_t(gltf_interpolation::step);
+            keep.push_back(0);
+            for (uint32_t k = 1; k + 1 < c.key_count; ++k) {
+                uint32_t const a = keep.back(), b = k + 1;
+                bool fits = true;
+                for (uint32_t i = a + 1; i <= k && fits; ++i) {
+                    float va[4], vb[4], v[4];
+                    for (int j = 0; j < c.components; ++j) {
+                        va[j] = set.value(c, a, j);
+                        vb[j] = set.value(c, step ? a : b, j);   // a step holds key a
+                    }
+                    float const span = times[b] - times[a];
+                    blend(rotation, va, vb, span > 0 ? (times[i] - times[a]) / span : 0.0f, c.components, v);
+                    for (int j = 0; j < c.components; ++j)
+                        fits = fits && std::abs(v[j] - set.value(c, i, j)) <= tolerance;
+                }
+                if (!fits) keep.push_back(k);
+            }
+            keep.push_back(c.key_count - 1);
+        }
+
+        auto const range = std::make_pair(c.first_key, c.key_count);
+        if (keep.size() == c.key_count && kept_times.count(range)) {
+            c.first_key = kept_times[range];
+        } else {
+            uint32_t const first = uint32_t(reduced.times.size());
+            for (uint32_t k : keep) reduced.times.push_back(times[k]);
+            if (keep.size() == c.key_count) kept_times[range] = first;
+            c.first_key = first;
+        }
+        if (!c.quantized) {
+            uint32_t const first = uint32_t(reduced.values.size());
+            for (uint32_t k : keep)
+                for (uint32_t v = 0; v < c.key_values(); ++v)
+                    for (int j = 0; j < c.components; ++j)
+                        reduced.values.push_back(set.value(c, k * c.key_values() + v, j));
+            c.first_value = first;
+        }
+        c.key_count = uint32_t(keep.size());
+        reduced.channels.push_back(c);
+    }
+    set = std::move(reduced);
+}
+
+void gltf_quantize_animations(gltf_animation_set& set)
+{
+    for (gltf_animation_channel& c : set.channels) {
+        if (c.quantized) continue;
+        size_t const count = size_t(c.key_count) * c.key_values();
+        for (int j = 0; j < c.components; ++j) {
+            float lo = set.value(c, 0, j), hi = lo;
+            for (size_t v = 1; v < count; ++v) {
+                lo = std::min(lo, set.value(c, v, j));
+                hi = std::max(hi, set.value(c, v, j));
+            }
+            c.value_min[j]   = lo;
+            c.value_range[j] = hi - lo;
+        }
+        uint32_t const first = uint32_t(set.packed.size());
+        for (size_t v = 0; v < count; ++v)
+            for (int j = 0; j < c.components; ++j) {
+                float const x = c.value_range[j] > 0 ? (set.value(c, v, j) - c.value_min[j]) / c.value_range[j] : 0.0f;
+                set.packed.push_back(uint16_t(std::lround(std::clamp(x, 0.0f, 1.0f) * 65535.0f)));
+            }
+        c.first_value = first;
+        c.quantized   = 1;
+    }
+    std::vector<float>().swap(set.values);   // every channel reads `packed` now
+}
@@ -0,0 +1,93 @@
+#pragma once
+// gltf_animation.hpp
+// Animation clips of a glTF asset (model.animations), restricted to the
+// translation / rotation / scale of the skin's joints.
+//
+// Every curve of every clip lives in three shared pools, so that the whole
+// set is a handful of flat arrays (stored as is in the mesh cache):
+//   - times  : key times, shared by the channels reading the same accessor
+//   - values : `components` floats per key (x3 for cubic splines: in-tangent,
+//              value, out-tangent)
+//   - packed : the same, quantized to 16 bits per component with a per
+//              channel range (gltf_quantize_animations)
+// Sampling keeps a cursor per channel (the key of the previous sample), so
+// that playing a clip forward costs O(1) per channel and frame; a jump
+// backwards or far ahead falls back to a binary search.
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "cgp/cgp.hpp"
+#include "tiny_gltf.h"
+
+enum class gltf_channel_path  : uint8_t { translation = 0, rotation = 1, scale = 2 };
+enum class gltf_interpolation : uint8_t { step = 0, linear = 1, cubic_spline = 2 };
+
+/// One animated property of one joint
+struct gltf_animation_channel {
+    int32_t  clip          = 0;
+    int32_t  joint         = 0;    ///< skin joint (index in JOINTS_0)
+    uint8_t  path          = 0;    ///< gltf_channel_path
+    uint8_t  interpolation = 1;    ///< gltf_interpolation
+    uint8_t  components    = 3;    ///< 4 for rotations (x, y, z, w)
+    uint8_t  quantized     = 0;    ///< values in `packed` rather than `values`
+    uint32_t first_key     = 0;    ///< in times
+    uint32_t key_count     = 0;
+    uint32_t first_value   = 0;    ///< in values, or packed
+    float    value_min[4]   = {};  ///< quantized: min + range * q / 65535
+    float    value_range[4] = {};
+
+    /// Values per key (3 for cubic splines)
+    uint32_t key_values() const { return interpolation == uint8_t(gltf_interpolation::cubic_spline) ? 3u : 1u; }
+};
+
+struct gltf_animation_clip {
+    char     name[56]      = {};   ///< '\0'-terminated (truncated)
+    float    duration      = 0;    ///< last key time of its channels (s)
+    uint32_t first_channel = 0;
+    uint32_t channel_count = 0;
+};
+
+struct gltf_animation_set {
+    std::vector<gltf_animation_clip>    clips;
+    std::vector<gltf_animation_channel> channels;   ///< grouped by clip
+    std::vector<float>                  times;
+    std::vector<float>                  values;
+    std::vector<uint16_t>               packed;
+
+    /// Clip index, -1 if there is none of that name
+    int    find(std::string_view name) const;
+    size_t key_count() const;
+    size_t bytes() const;
+    /// Component `i` of value `v` of channel `c` (v counts the tangents of cubic splines)
+    float  value(gltf_animation_channel const& c, size_t v, int i) const
+    {
+        size_t const k = c.first_value + v * c.components + size_t(i);
+        return c.quantized ? c.value_min[i] + c.value_range[i] * (packed[k] / 65535.0f) : values[k];
+    }
+};
+
+/**
+ * Read every animation of `model` whose channels target joints of the skin
+ * (`joint_of_node`: node index -> joint, -1). Morph weights and channels on
+ * other nodes are skipped, malformed samplers too (with a message).
+ * @throw std::runtime_error if an accessor points outside its buffer.
+ */
+void gltf_load_animations(const tinygltf::Model& model, std::vector<int> const& joint_of_node,
+                          gltf_animation_set& out);
+
+/// Drop the keys of step and linear channels that their neighbours
+/// reproduce within `tolerance` (on every component). Quantized and cubic
+/// channels are kept as they are.
+void gltf_reduce_animations(gltf_animation_set& set, float tolerance);
+
+/// Move every channel to 16-bit values (about range / 65535 of error)
+void gltf_quantize_animations(gltf_animation_set& set);
+
+/**
+ * Value of channel `c` at time `t` (clamped to its keys) into `out`
+ * (`c.components` floats, unit quaternion for rotations). `cursor` is the key
+ * found by the previous call on this channel, updated.
+ */
+void gltf_sample_channel(gltf_animation_set const& set, gltf_animation_channel const& c,
+                         uint32_t& cursor, float t, float out[4]);
@@ -2,9 +2,18 @@
 #define STB_IMAGE_IMPLEMENTATION          // let TinyGLTF decode PNG/JPG
 #define STB_IMAGE_WRITE_IMPLEMENTATION     // not strictly required for loading
 #include "gltf_loader.hpp"
+#include "gltf_accessor.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_simplify.hpp"
+#include "texture_loader.hpp"
 #include "cgp/cgp.hpp"
+#include <cmath>
 using namespace cgp;
 
+/// Keys dropped from the clips when their neighbours give them back within
+/// this (exporters bake a key per frame, most of them on straight segments)
+static constexpr float animation_key_tolerance = 1e-5f;
+
 
 
 /* -------------------------------------------------------------------------- */
@@ -13,215 +22,364 @@ using namespace cgp;
 static void upload_texture_from_gltf(const tinygltf::Image& img,
         cgp::opengl_texture_image_structure& tex,
         GLint wrap = GL_REPEAT)
-    {
-    using cgp::vec3;
-    using cgp::grid_2D;
-
-    const int w = img.width;
-    const int h = img.height;
-
-    /* ----- fill a grid_2D<vec3> with RGB values -------------------------- */
-    grid_2D<vec3> rgb;          // (x = column, y = row)
-    rgb.resize(w, h);
-
-    const unsigned char* src = img.image.data();
-    for (int y = 0; y < h; ++y)
-    for (int x = 0; x < w; ++x)
-    {
-    int i = (y * w + x) * img.component;
-    rgb(x, y) = {
-    src[i + 0] / 255.0f,
-    src[i + 1] / 255.0f,
-    src[i + 2] / 255.0f
-    };
-    }
-
-    /* ----- upload -------------------------------------------------------- */
-    tex.initialize_texture_2d_on_gpu(
-    rgb,                 // <- matches the overload grid_2D<vec3> const&
-    wrap, wrap,
-    /*is_mipmap=*/true);
+{
+    /* ----- decoded 8/16-bit pixels go to GL as they are (texture_loader) -- */
+    texture_upload_raw(tex, img.image.data(), img.width, img.height,
+                       img.component, img.bits, wrap, /*mipmap=*/true);
 }
 
 
 /* -------------------------------------------------------------------------- */
-/*  mesh_load_file_gltf - minimal loader that fills a cgp::mesh               */
+/*  gltf_load_model - parse .gltf / .glb with TinyGLTF                        */
 /* -------------------------------------------------------------------------- */
-/* convert 16 consecutive floats (column-major) to a cgp::mat4 */
-static cgp::mat4 make_mat4(const float* m);
-gltf_geometry_and_texture mesh_load_file_gltf(const std::string& filename)
+tinygltf::Model gltf_load_model(const std::string& filename)
 {
     tinygltf::TinyGLTF loader;
     tinygltf::Model    model;
     std::string        warn, err;
 
     /* -------- read .glb (binary) or .gltf (text + externals) -------------- */
-    auto load_model_from_file = [&](const std::string& file) -> bool
-    {
-        auto ext = file.substr(file.find_last_of('.') + 1);
-        if (ext == "glb" || ext == "GLB")
-            return loader.LoadBinaryFromFile(&model, &err, &warn, file);
-        else                                   // treat everything else as .gltf
-            return loader.LoadASCIIFromFile (&model, &err, &warn, file);
-    };
+    auto ext = filename.substr(filename.find_last_of('.') + 1);
+    bool ok;
+    if (ext == "glb" || ext == "GLB")
+        ok = loader.LoadBinaryFromFile(&model, &err, &warn, filename);
+    else                                       // treat everything else as .gltf
+        ok = loader.LoadASCIIFromFile (&model, &err, &warn, filename);
 
-    bool ok = load_model_from_file(filename);
     if (!ok)
         throw std::runtime_error("TinyGLTF error while loading " + filename +
                                 "\nWarn: " + warn + "\nErr : " + err);
-    
-    /* ---- for simplicity, use the *first* mesh and *first* primitive ------ */
-    const auto& prim  = model.meshes.at(0).primitives.at(0);
-    gltf_geometry_and_texture result;
+    return model;
+}
 
-    /* -------------------------------------------------------------------------- */
-    /*  Helpers that copy attribute data into a numarray<vec3> / numarray<vec2>   */
-    /* -------------------------------------------------------------------------- */
-    auto copy_vec3 = [&](const std::string& attr, cgp::numarray<cgp::vec3>& dst)
-    {
-        auto it = prim.attributes.find(attr);
-        if (it == prim.attributes.end()) return;
 
-        const auto& acc  = model.accessors[it->second];
-        const auto& view = model.bufferViews[acc.bufferView];
-        const auto& buf  = model.buffers[view.buffer];
+/* -------------------------------------------------------------------------- */
+/*  gltf_upload_textures - GL part, on the context thread                     */
+/* -------------------------------------------------------------------------- */
+void gltf_upload_textures(gltf_geometry_and_texture& data, const std::string& filename)
+{
+    for (auto& [index, image] : data.images) {
+        std::string const key = resource_manager::make_key(resource_kind::texture, filename,
+                                                           "image=" + std::to_string(index));
+        std::shared_ptr<texture_resource> t = resources().find<texture_resource>(key);
+        if (t == nullptr) {
+            t = std::make_shared<texture_resource>();
+            upload_texture_from_gltf(image, t->texture);
+            t->gpu_bytes = image.image.size() * 4 / 3;      // + mip chain
+            resources().insert(key, t);
+        }
+        data.textures[index] = t;
+    }
+    data.images.clear();                     // CPU copy no longer needed
 
-        const float* f = reinterpret_cast<const float*>(
-            buf.data.data() + view.byteOffset + acc.byteOffset);
+    if (!data.submeshes.empty() && data.textures.count(data.submeshes[0].image))
+        data.tex = data.textures[data.submeshes[0].image]->texture;   // store in the struct, **not** in the mesh
+}
 
-        dst.resize(acc.count);
-        for (size_t i = 0; i < acc.count; ++i)
-            dst[i] = { f[3*i], f[3*i+1], f[3*i+2] };
-    };
 
-    auto copy_vec2 = [&](const std::string& attr, cgp::numarray<cgp::vec2>& dst)
-    {
-        auto it = prim.attributes.find(attr);
-        if (it == prim.attributes.end()) return;
+/* -------------------------------------------------------------------------- */
+/*  Node hierarchy                                                            */
+/* -------------------------------------------------------------------------- */
+/// Translation, rotation and scale fields of a node (defaults where absent)
+static gltf_joint_rest node_trs_fields(const tinygltf::Node& node)
+{
+    gltf_joint_rest trs;
+    if (node.translation.size() == 3)
+        trs.translation = { float(node.translation[0]), float(node.translation[1]), float(node.translation[2]) };
+    if (node.rotation.size() == 4)
+        trs.rotation = { float(node.rotation[0]), float(node.rotation[1]),
+                         float(node.rotation[2]), float(node.rotation[3]) };
+    if (node.scale.size() == 3)
+        trs.scale = { float(node.scale[0]), float(node.scale[1]), float(node.scale[2]) };
+    return trs;
+}
 
-        const auto& acc  = model.accessors[it->second];
-        const auto& view = model.bufferViews[acc.bufferView];
-        const auto& buf  = model.buffers[view.buffer];
+/// Local transform of a node: its `matrix`, or translation * rotation * scale
+static cgp::mat4 node_local_matrix(const tinygltf::Node& node)
+{
+    cgp::mat4 M = cgp::mat4::build_identity();
+    if (node.matrix.size() == 16) {
+        for (int col = 0; col < 4; ++col)                  // glTF is column-major
+            for (int row = 0; row < 4; ++row)
+                M(row, col) = float(node.matrix[4 * col + row]);
+        return M;
+    }
 
-        const float* f = reinterpret_cast<const float*>(
-            buf.data.data() + view.byteOffset + acc.byteOffset);
+    gltf_joint_rest const trs = node_trs_fields(node);
+    return gltf_trs_matrix(trs.translation, trs.rotation, trs.scale);
+}
 
-        dst.resize(acc.count);
-        for (size_t i = 0; i < acc.count; ++i)
-            dst[i] = { f[2*i], f[2*i+1] };
-    };
+/// Inverse of gltf_trs_matrix for a matrix without shear
+static gltf_joint_rest decompose_trs(const cgp::mat4& M)
+{
+    gltf_joint_rest trs;
+    trs.translation = { M(0, 3), M(1, 3), M(2, 3) };
+
+    float r[3][3];
+    for (int col = 0; col < 3; ++col) {
+        trs.scale[col] = std::sqrt(M(0, col)*M(0, col) + M(1, col)*M(1, col) + M(2, col)*M(2, col));
+        for (int row = 0; row < 3; ++row)
+            r[row][col] = trs.scale[col] > 0 ? M(row, col) / trs.scale[col] : float(row == col);
+    }
+    float const det = r[0][0] * (r[1][1]*r[2][2] - r[1][2]*r[2][1])
+                    - r[0][1] * (r[1][0]*r[2][2] - r[1][2]*r[2][0])
+                    + r[0][2] * (r[1][0]*r[2][1] - r[1][1]*r[2][0]);
+    if (det < 0) {                                     // mirror: carried by the scale
+        trs.scale[0] = -trs.scale[0];
+        for (int row = 0; row < 3; ++row) r[row][0] = -r[row][0];
+    }
 
-    auto copy_uint4 = [&](const std::string& attr,
-            cgp::numarray<cgp::uint4>& dst)
-    {
-        auto it = prim.attributes.find(attr);
-        if (it == prim.attributes.end()) return;
+    trs.rotation = gltf_rotation_quaternion(r);
+    return trs;
+}
 
-        const auto& acc  = model.accessors[it->second];
-        const auto& view = model.bufferViews[acc.bufferView];
-        const auto& buf  = model.buffers[view.buffer];
+/// Local TRS of a node (decomposed when it is given as a matrix)
+static gltf_joint_rest node_local_trs(const tinygltf::Node& node)
+{
+    return node.matrix.size() == 16 ? decompose_trs(node_local_matrix(node)) : node_trs_fields(node);
+}
 
-        const unsigned char* d = buf.data.data()+view.byteOffset+acc.byteOffset;
-        const uint16_t* u16 = reinterpret_cast<const uint16_t*>(d);
-        const uint8_t * u8  = reinterpret_cast<const uint8_t *> (d);
+/// Root nodes of the default scene (or of the whole node forest if there is no scene)
+static std::vector<int> scene_roots(const tinygltf::Model& model)
+{
+    if (!model.scenes.empty())
+        return model.scenes.at(model.defaultScene >= 0 ? model.defaultScene : 0).nodes;
 
-        dst.resize(acc.count);
+    std::vector<bool> is_child(model.nodes.size(), false);
+    for (const auto& node : model.nodes)
+        for (int c : node.children) is_child.at(c) = true;
+
+    std::vector<int> roots;
+    for (int k = 0; k < int(model.nodes.size()); ++k)
+        if (!is_child[k]) roots.push_back(k);
+    return roots;
+}
 
-        if(acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE){
-        for(size_t i=0;i<acc.count;++i)
-        dst[i] = {u8[4*i+0],u8[4*i+1],u8[4*i+2],u8[4*i+3]};
-        }else{ /* assume UNSIGNED_SHORT */
-        for(size_t i=0;i<acc.count;++i)
-        dst[i] = {u16[4*i+0],u16[4*i+1],u16[4*i+2],u16[4*i+3]};
-        }
-    };
 
-    auto copy_vec4f = [&](const std::string& attr,cgp::numarray<cgp::vec4>& dst){ 
+/* -------------------------------------------------------------------------- */
+/*  Primitive → merged buffers                                                */
+/* -------------------------------------------------------------------------- */
+/**
+ * Append one triangle primitive to `result` and record its draw range.
+ * Positions and normals are moved by `world` unless the node is skinned
+ * (skinned vertices are already expressed in the skeleton's space).
+ * In a skinned model, parts without JOINTS_0 are rigidly bound to joint 0.
+ */
+static void append_primitive(const tinygltf::Model& model,
+                             const tinygltf::Primitive& prim,
+                             const cgp::mat4& world, bool apply_world,
+                             gltf_geometry_and_texture& result)
+{
+    cgp::mesh                 part;
+    cgp::numarray<cgp::uint4> joints;
+    cgp::numarray<cgp::vec4>  weights;
+
+    /* ------------------- attributes (see gltf_accessor) ------------------- */
+    auto read_attribute = [&](const std::string& attr, auto& dst)
+    {
         auto it = prim.attributes.find(attr);
-        if(it==prim.attributes.end()) return;
-        const auto& acc  = model.accessors[it->second];
-        const auto& view = model.bufferViews[acc.bufferView];
-        const auto& buf  = model.buffers[view.buffer];
-        const float* f = reinterpret_cast<const float*>(
-        buf.data.data()+view.byteOffset+acc.byteOffset);
-        dst.resize(acc.count);
-        for(size_t i=0;i<acc.count;++i)
-        dst[i] = {f[4*i],f[4*i+1],f[4*i+2],f[4*i+3]};
+        if (it != prim.attributes.end())
+            accessor_read(model, it->second, dst);
     };
+    read_attribute("POSITION"   , part.position);
+    read_attribute("NORMAL"     , part.normal);
+    read_attribute("TEXCOORD_0" , part.uv);
+    read_attribute("JOINTS_0"   , joints);
+    read_attribute("WEIGHTS_0"  , weights);
 
-    /* -------------------------------------------------------------------------- */
-    /*  Use them for each attribute                                               */
-    /* -------------------------------------------------------------------------- */
-    copy_vec3("POSITION"   , result.geom.position);
-    copy_vec3("NORMAL"     , result.geom.normal);
-    copy_vec2("TEXCOORD_0" , result.geom.uv);
-    copy_uint4("JOINTS_0" , result.joint_index);
-    copy_vec4f("WEIGHTS_0", result.joint_weight);
+    const size_t n_vertex = part.position.size();
+    if (n_vertex == 0) return;
 
     /* ---------------------- indices → connectivity ------------------------ */
-    if (prim.indices < 0)
-        throw std::runtime_error("Primitive has no indices - glTF requires them");
-
-    const auto& accI  = model.accessors [prim.indices];
-    const auto& viewI = model.bufferViews[accI.bufferView];
-    const auto& bufI  = model.buffers   [viewI.buffer];
-    const unsigned char* base = bufI.data.data() + viewI.byteOffset + accI.byteOffset;
-
-    result.geom.connectivity.resize(accI.count / 3);      // triangles
-
-    if (accI.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-    {
-        const uint16_t* id = reinterpret_cast<const uint16_t*>(base);
-        for (size_t t = 0; t < result.geom.connectivity.size(); ++t)
-            result.geom.connectivity[t] = { id[3*t], id[3*t+1], id[3*t+2] };
+    if (prim.indices >= 0)
+        accessor_read(model, prim.indices, part.connectivity);
+    else {                                   // non-indexed: vertices 3 by 3
+        part.connectivity.resize(n_vertex / 3);
+        for (size_t t = 0; t < n_vertex / 3; ++t)
+            part.connectivity[t] = { uint32_t(3*t), uint32_t(3*t + 1), uint32_t(3*t + 2) };
     }
-    else  /* assume uint32 */
-    {
-        const uint32_t* id = reinterpret_cast<const uint32_t*>(base);
-        for (size_t t = 0; t < result.geom.connectivity.size(); ++t)
-            result.geom.connectivity[t] = { id[3*t], id[3*t+1], id[3*t+2] };
+
+    /* fall-back if normals / uv weren’t provided */
+    if (part.normal.size() != n_vertex)
+        part.normal_update();
+    if (part.uv.size() != n_vertex)
+        part.uv.data.assign(n_vertex, cgp::vec2{ 0, 0 });
+
+    if (apply_world) {
+        const cgp::mat3 L = cgp::mat3(world);
+        const cgp::mat3 N = transpose(inverse(L));   // normal matrix
+        const cgp::vec3 T = { world(0,3), world(1,3), world(2,3) };
+        for (size_t k = 0; k < n_vertex; ++k) {
+            part.position[k] = L * part.position[k] + T;
+            part.normal[k]   = normalize(N * part.normal[k]);
+        }
     }
 
-    /* fall-back if normals weren’t provided */
-    if (result.geom.normal.size() == 0)
-        result.geom.normal_update();
+    if (!model.skins.empty() && (joints.size() != n_vertex || weights.size() != n_vertex)) {
+        joints.data.assign(n_vertex, cgp::uint4{ 0, 0, 0, 0 });
+        weights.data.assign(n_vertex, cgp::vec4{ 1, 0, 0, 0 });
+    }
 
-    static std::unordered_map<int,cgp::opengl_texture_image_structure> cache; // key = image index
+    /* --------------------------- merge ------------------------------------ */
+    const uint32_t base_vertex = uint32_t(result.geom.position.size());
 
-    int texIndex = -1;
+    gltf_submesh sub;
+    sub.first_triangle = uint32_t(result.geom.connectivity.size());
+    sub.triangle_count = uint32_t(part.connectivity.size());
+    sub.material       = prim.material;
     if (prim.material >= 0) {
-        const auto& mat = model.materials[prim.material];
-        texIndex = mat.pbrMetallicRoughness.baseColorTexture.index;
+        const auto& pbr = model.materials.at(prim.material).pbrMetallicRoughness;
+        if (pbr.baseColorTexture.index >= 0)
+            sub.image = model.textures.at(pbr.baseColorTexture.index).source;
+        if (pbr.baseColorFactor.size() == 4)
+            sub.base_color = { float(pbr.baseColorFactor[0]), float(pbr.baseColorFactor[1]),
+                               float(pbr.baseColorFactor[2]), float(pbr.baseColorFactor[3]) };
     }
+    result.submeshes.push_back(sub);
+
+    auto append = [](auto& dst, const auto& src) {
+        dst.data.insert(dst.data.end(), src.data.begin(), src.data.end());
+    };
+    append(result.geom.position, part.position);
+    append(result.geom.normal,   part.normal);
+    append(result.geom.uv,       part.uv);
+    append(result.joint_index,   joints);
+    append(result.joint_weight,  weights);
+
+    for (const cgp::uint3& tri : part.connectivity.data)
+        result.geom.connectivity.push_back({ tri[0] + base_vertex,
+                                             tri[1] + base_vertex,
+                                             tri[2] + base_vertex });
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  mesh_load_file_gltf - every primitive of the scene in one cgp::mesh       */
+/* -------------------------------------------------------------------------- */
+gltf_geometry_and_texture mesh_load_file_gltf(const std::string& filename,
+                                              bool load_texture,
+                                              bool optimize)
+{
+    tinygltf::Model model = gltf_load_model(filename);
+    gltf_geometry_and_texture result;
 
-    if (texIndex >= 0) {
-        int imgIndex = model.textures[texIndex].source;
-        if (!cache.count(imgIndex))
-            upload_texture_from_gltf(model.images[imgIndex], cache[imgIndex]);
-        result.tex = cache[imgIndex];          // store in the struct, **not** in the mesh
+    auto append_mesh = [&](int mesh_index, const cgp::mat4& world, bool apply_world)
+    {
+        for (const auto& prim : model.meshes.at(mesh_index).primitives) {
+            if (prim.mode != TINYGLTF_MODE_TRIANGLES && prim.mode != -1) {
+                std::cerr << "[gltf_loader] " << filename << ": skipping non-triangle primitive of mesh "
+                          << mesh_index << " (mode " << prim.mode << ")" << std::endl;
+                continue;
+            }
+            append_primitive(model, prim, world, apply_world, result);
+        }
+    };
+
+    /* ---- depth-first walk of the node hierarchy, accumulating transforms - */
+    std::vector<std::pair<int, cgp::mat4>> stack;
+    std::vector<cgp::mat4> node_world(model.nodes.size(), cgp::mat4::build_identity());
+    std::vector<int>       node_parent(model.nodes.size(), -1);
+    const std::vector<int> roots = scene_roots(model);
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+        stack.push_back({ *it, cgp::mat4::build_identity() });
+
+    while (!stack.empty()) {
+        auto [node_index, parent] = stack.back();
+        stack.pop_back();
+
+        const tinygltf::Node& node = model.nodes.at(node_index);
+        const cgp::mat4 world = parent * node_local_matrix(node);
+        node_world[node_index] = world;
+        if (node.mesh >= 0)
+            append_mesh(node.mesh, world, /*apply_world=*/node.skin < 0);
+        for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+            node_parent.at(*it) = node_index;
+            stack.push_back({ *it, world });
+        }
     }
 
+    /* ---- no node refers to a mesh: take the meshes as they are ----------- */
+    if (result.submeshes.empty())
+        for (int m = 0; m < int(model.meshes.size()); ++m)
+            append_mesh(m, cgp::mat4::build_identity(), false);
+
+    if (result.geom.connectivity.size() == 0)
+        throw std::runtime_error("No triangle primitive found in " + filename);
+
+    /* ---- decoded base color images, uploaded by gltf_upload_textures ----- */
+    for (const gltf_submesh& sub : result.submeshes)
+        if (sub.image >= 0 && !result.images.count(sub.image))
+            result.images[sub.image] = std::move(model.images.at(sub.image));
+
     if(!model.skins.empty()){
+        // every skinned node is assumed to use skin 0 (one skeleton per asset)
         const tinygltf::Skin& skin = model.skins[0];
     
         /* joint → node index list */
         result.joint_node = skin.joints;            // vector<int>
     
-        /* inverse bind matrices */
-        const auto& accIBM   = model.accessors[skin.inverseBindMatrices];
-        const auto& viewIBM  = model.bufferViews[accIBM.bufferView];
-        const auto& bufIBM   = model.buffers[viewIBM.buffer];
-        const float*  mdata  = reinterpret_cast<const float*>(
-                bufIBM.data.data() + viewIBM.byteOffset + accIBM.byteOffset);
-    
-        size_t njoint = accIBM.count;
-        result.inverse_bind.resize(njoint);
-        result.inverse_bind.resize(njoint);
-        for(size_t j = 0; j < njoint; ++j)
-            result.inverse_bind[j] = make_mat4(mdata + 16*j);
+        /* inverse bind matrices (identity when absent, as per the spec) */
+        if (skin.inverseBindMatrices >= 0)
+            accessor_read(model, skin.inverseBindMatrices, result.inverse_bind);
+        else
+            result.inverse_bind.assign(skin.joints.size(), cgp::mat4::build_identity());
+
+        /* skeleton: nearest joint ancestor and rest transform relative to it.
+           Non-joint nodes in between are folded into the child's rest TRS,
+           those above the roots into skeleton_base. */
+        std::vector<int> joint_of_node(model.nodes.size(), -1);
+        for (size_t j = 0; j < skin.joints.size(); ++j)
+            joint_of_node.at(skin.joints[j]) = int(j);
+
+        auto joint_ancestor = [&](int node) {
+            int a = node_parent[node];
+            while (a >= 0 && joint_of_node[a] < 0) a = node_parent[a];
+            return a;
+        };
+        int base_node = -1;
+        for (int node : skin.joints)
+            if (joint_ancestor(node) < 0) { base_node = node_parent[node]; break; }
+        if (base_node >= 0)
+            result.skeleton_base = node_world[base_node];
+
+        result.joint_parent.resize(skin.joints.size());
+        result.joint_rest.resize(skin.joints.size());
+        for (size_t j = 0; j < skin.joints.size(); ++j) {
+            const int node   = skin.joints[j];
+            const int parent = joint_ancestor(node);
+            const int above  = parent >= 0 ? parent : base_node;
+            result.joint_parent[j] = parent >= 0 ? joint_of_node[parent] : -1;
+            if (node_parent[node] == above)
+                result.joint_rest[j] = node_local_trs(model.nodes[node]);
+            else
+                result.joint_rest[j] = decompose_trs(inverse(above >= 0 ? node_world[above] : result.skeleton_base)
+                                                     * node_world[node]);
+        }
+
+        /* clips on the joints, without the keys a straight segment reproduces */
+        if (!model.animations.empty()) {
+            gltf_load_animations(model, joint_of_node, result.animations);
+            size_t const keys = result.animations.key_count();
+            gltf_reduce_animations(result.animations, animation_key_tolerance);
+            std::cout << "[gltf_loader] " << filename << ": " << result.animations.clips.size() << " clips, "
+                      << result.animations.channels.size() << " channels, " << keys << " -> "
+                      << result.animations.key_count() << " keys" << std::endl;
+        }
     }
     
+    /* external buffers, relative to the .gltf (used to invalidate caches) */
+    for (const auto& b : model.buffers)
+        if (!b.uri.empty() && b.uri.rfind("data:", 0) != 0)
+            result.source_files.push_back(b.uri);
+
     result.geom.fill_empty_field();
+    if (optimize) {
+        mesh_build_lods(result);
+        mesh_optimize(result);
+    }
+    if (load_texture)
+        gltf_upload_textures(result, filename);
+
     if (!model.skins.empty())
     {
         std::cout << "joint  node  name\n";
@@ -232,14 +390,3 @@ gltf_geometry_and_texture mesh_load_file_gltf(const std::string& filename)
 }
     return result;
 }
-
-/* convert 16 consecutive floats (column-major) to a cgp::mat4 */
-static cgp::mat4 make_mat4(const float* m)
-{
-    cgp::mat4 M;
-    for(int col=0; col<4; ++col)
-        for(int row=0; row<4; ++row)
-            M(row,col) = m[4*col + row];   // CGP stores column-major
-    return M;
-}
-
@@ -3,27 +3,115 @@
 // Forward-declaration of the helper that converts a .gltf / .glb into a cgp::mesh
 // The implementation lives in gltf_loader.cpp
 
+#include <cmath>
+#include <map>
 #include <string>
 #include "cgp/cgp.hpp"   // brings in cgp::mesh
 #include "tiny_gltf.h"
+#include "resource_manager.hpp"
+#include "gltf_animation.hpp"
 
 
 /**
- * Load the first mesh / first primitive found in a .gltf or .glb file and
- * return it as a cgp::mesh ready to send to initialize_data_on_gpu().
+ * Load every triangle primitive reachable from the scene nodes of a .gltf or
+ * .glb file into one merged cgp::mesh ready to send to initialize_data_on_gpu().
+ * Each primitive keeps its triangle range and material in `submeshes`.
  *
  * @param filename  Absolute or relative path to the file (".gltf" or ".glb")
  * @throw std::runtime_error on I/O or parsing errors.
  */
 
+/// One glTF primitive inside the merged vertex / index buffers
+struct gltf_submesh {
+    uint32_t  first_triangle = 0;     ///< offset in geom.connectivity
+    uint32_t  triangle_count = 0;
+    int32_t   material       = -1;    ///< glTF material index, -1 = none
+    int32_t   image          = -1;    ///< glTF image of the base color texture, -1 = none
+    cgp::vec4 base_color     = { 1, 1, 1, 1 };  ///< baseColorFactor (rgb, alpha)
+};
+
+/// Local rest transform of a joint, relative to its parent joint (glTF TRS)
+struct gltf_joint_rest {
+    cgp::vec3 translation = { 0, 0, 0 };
+    cgp::vec4 rotation    = { 0, 0, 0, 1 };   ///< unit quaternion (x, y, z, w)
+    cgp::vec3 scale       = { 1, 1, 1 };
+};
+
+/// translation * rotation * scale, as glTF composes a node's TRS
+inline cgp::mat4 gltf_trs_matrix(cgp::vec3 const& t, cgp::vec4 const& q, cgp::vec3 const& s)
+{
+    float const x = q.x, y = q.y, z = q.z, w = q.w;
+    float const R[3][3] = {
+        { 1 - 2*(y*y + z*z),     2*(x*y - w*z),     2*(x*z + w*y) },
+        {     2*(x*y + w*z), 1 - 2*(x*x + z*z),     2*(y*z - w*x) },
+        {     2*(x*z - w*y),     2*(y*z + w*x), 1 - 2*(x*x + y*y) } };
+
+    cgp::mat4 M = cgp::mat4::build_identity();
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col)
+            M(row, col) = R[row][col] * s[col];
+        M(row, 3) = t[row];
+    }
+    return M;
+}
+
+/// Unit quaternion (x, y, z, w) of a rotation matrix r[row][col]
+inline cgp::vec4 gltf_rotation_quaternion(float const r[3][3])
+{
+    float const trace = r[0][0] + r[1][1] + r[2][2];
+    if (trace > 0) {
+        float const s = 2 * std::sqrt(1 + trace);
+        return { (r[2][1] - r[1][2]) / s, (r[0][2] - r[2][0]) / s, (r[1][0] - r[0][1]) / s, s / 4 };
+    }
+    if (r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+        float const s = 2 * std::sqrt(1 + r[0][0] - r[1][1] - r[2][2]);
+        return { s / 4, (r[0][1] + r[1][0]) / s, (r[0][2] + r[2][0]) / s, (r[2][1] - r[1][2]) / s };
+    }
+    if (r[1][1] > r[2][2]) {
+        float const s = 2 * std::sqrt(1 + r[1][1] - r[0][0] - r[2][2]);
+        return { (r[0][1] + r[1][0]) / s, s / 4, (r[1][2] + r[2][1]) / s, (r[0][2] - r[2][0]) / s };
+    }
+    float const s = 2 * std::sqrt(1 + r[2][2] - r[0][0] - r[1][1]);
+    return { (r[0][2] + r[2][0]) / s, (r[1][2] + r[2][1]) / s, s / 4, (r[1][0] - r[0][1]) / s };
+}
+
  struct gltf_geometry_and_texture {
     cgp::mesh          geom;        // positions, normals, uv, connectivity …
-    cgp::opengl_texture_image_structure tex;
+    cgp::opengl_texture_image_structure tex;   // texture of the first submesh
+
+    std::vector<gltf_submesh> submeshes;       // draw ranges, in node order
+    std::vector<gltf_submesh> lod_submeshes;   // LOD 1, 2 … : submeshes.size() ranges per level,
+                                               // after LOD 0 in geom.connectivity (mesh_build_lods)
+    std::map<int, std::shared_ptr<texture_resource>> textures;  // image index → texture
+    std::map<int, tinygltf::Image> images;     // decoded, not uploaded yet (image index)
 
     cgp::numarray<cgp::uint4> joint_index;   // JOINTS_0
     cgp::numarray<cgp::vec4>  joint_weight;  // WEIGHTS_0
 
     std::vector<cgp::mat4>    inverse_bind;  // one per joint
     std::vector<int>          joint_node;    // maps joint → node index
+    std::vector<int>             joint_parent;  // parent joint, -1 for the roots
+    std::vector<gltf_joint_rest> joint_rest;    // local rest transform, relative to the parent joint
+    cgp::mat4 skeleton_base = cgp::mat4::build_identity();  // nodes above the root joints
+    gltf_animation_set        animations;    // clips on the joints (keys reduced, see gltf_loader.cpp)
+
+    std::vector<std::string>  source_files;  // external .bin buffers the .gltf refers to
 };
-gltf_geometry_and_texture mesh_load_file_gltf(const std::string& filename);
+
+/// Parse a .gltf / .glb (with its buffers and images) into a TinyGLTF model.
+/// @throw std::runtime_error on I/O or parsing errors.
+tinygltf::Model gltf_load_model(const std::string& filename);
+
+/**
+ * @param load_texture  false = no OpenGL call: the decoded images are left in
+ *                      `images` (for a worker thread, or when baking caches).
+ * @param optimize      build the LOD chain (mesh_simplify.hpp), then reorder
+ *                      triangles and vertices for the GPU caches (mesh_optimizer.hpp)
+ */
+gltf_geometry_and_texture mesh_load_file_gltf(const std::string& filename,
+                                              bool load_texture = true,
+                                              bool optimize = true);
+
+/// Upload `data.images` (GL thread) into `data.textures` / `data.tex`, through
+/// the resource manager (key: `filename` + image index).
+void gltf_upload_textures(gltf_geometry_and_texture& data, const std::string& filename);
@@ -1,34 +1,70 @@
 #pragma once
 
 
+#include <cstddef>
+#include <vector>
 #include "cgp/cgp.hpp"   // brings in cgp::mesh
+#include "packed_vertex.hpp"
 
-/* Add JOINTS_0 / WEIGHTS_0 attributes to the VAO created by CGP */
-inline void add_skin_attributes(cgp::mesh_drawable& md,
-    const cgp::numarray<cgp::uint4>& joints,
-    const cgp::numarray<cgp::vec4 >& weights)
+/// Element buffer of a drawable: type and size of one index
+struct index_format { GLenum type = GL_UNSIGNED_INT; GLsizei size = sizeof(GLuint); };
+
+/// GL objects created by upload_packed_skin_mesh (owned by the caller)
+struct skin_buffers { GLuint vao = 0, vertices = 0, indices = 0; index_format format; };
+
+/* One interleaved VBO of packed_skin_vertex + the EBO, in a new VAO with the
+   attribute locations of turtle.vert.glsl:
+     0 position (unorm16 x3)   1 normal (octahedral snorm16 x2)
+     3 uv (half x2)            4 joints (uint8 x4)   5 weights (unorm16 x4)
+   Location 2 (color) is left disabled. Indices are 16-bit when every vertex
+   fits (0xFFFF is left free, it is the usual primitive restart index). */
+inline skin_buffers upload_packed_skin_mesh(const packed_skin_mesh& mesh,
+    const cgp::numarray<cgp::uint3>& triangles)
 {
-    GLuint vao = md.vao;
-    glBindVertexArray(vao);
+    skin_buffers b;
+    glGenVertexArrays(1, &b.vao);
+    glBindVertexArray(b.vao);
 
-    /* --- JOINTS -------------------------------------------------- */
-    GLuint vboJ;  glGenBuffers(1, &vboJ);
-    glBindBuffer(GL_ARRAY_BUFFER, vboJ);
+    /* --- VERTICES ------------------------------------------------ */
+    glGenBuffers(1, &b.vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, b.vertices);
     glBufferData(GL_ARRAY_BUFFER,
-        joints.size()*sizeof(cgp::uint4),
-        joints.data.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(4);
-    glVertexAttribIPointer(4, 4, GL_UNSIGNED_INT, sizeof(cgp::uint4), (void*)0);
+        mesh.vertices.size()*sizeof(packed_skin_vertex),
+        mesh.vertices.data(), GL_STATIC_DRAW);
 
-    /* --- WEIGHTS ------------------------------------------------- */
-    GLuint vboW;  glGenBuffers(1, &vboW);
-    glBindBuffer(GL_ARRAY_BUFFER, vboW);
-    glBufferData(GL_ARRAY_BUFFER,
-        weights.size()*sizeof(cgp::vec4),
-        weights.data.data(), GL_STATIC_DRAW);
+    GLsizei const stride = sizeof(packed_skin_vertex);
+    auto at = [](size_t offset) { return reinterpret_cast<void*>(offset); };
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, at(offsetof(packed_skin_vertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, at(offsetof(packed_skin_vertex, normal)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_HALF_FLOAT, GL_FALSE, stride, at(offsetof(packed_skin_vertex, uv)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 4, GL_UNSIGNED_BYTE, stride, at(offsetof(packed_skin_vertex, joints)));
     glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE,
-    sizeof(cgp::vec4), (void*)0);
+    glVertexAttribPointer(5, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, at(offsetof(packed_skin_vertex, weights)));
+
+    /* --- INDICES ------------------------------------------------- */
+    glGenBuffers(1, &b.indices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, b.indices);      // recorded in the VAO
+    if (mesh.vertices.size() < 0xFFFF) {
+        std::vector<GLushort> indices(3 * triangles.size());
+        for (size_t t = 0; t < triangles.size(); ++t)
+            for (int c = 0; c < 3; ++c)
+                indices[3 * t + c] = GLushort(triangles[t][c]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            indices.size()*sizeof(GLushort),
+            indices.data(), GL_STATIC_DRAW);
+        b.format = { GL_UNSIGNED_SHORT, sizeof(GLushort) };
+    }
+    else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            triangles.size()*sizeof(cgp::uint3),
+            triangles.data.data(), GL_STATIC_DRAW);
+    }
 
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return b;
 }
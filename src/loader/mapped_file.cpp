@@ -0,0 +1,88 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        bytes     = other.bytes;
+        length    = other.length;
+        is_mapped = other.is_mapped;
+        fallback  = std::move(other.fallback);
+        if (!is_mapped && bytes != nullptr)
+            bytes = fallback.data();    // the vector moved, re-point to it
+        other.bytes     = nullptr;
+        other.length    = 0;
+        other.is_mapped = false;
+    }
+    return *this;
+}
+
+bool mapped_file::open(std::string const& filename)
+{
+    close();
+
+#ifdef MAPPED_FILE_USE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* ptr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);                         // the mapping keeps its own reference
+    if (ptr == MAP_FAILED) return false;
+
+    bytes     = static_cast<unsigned char const*>(ptr);
+    length    = size_t(st.st_size);
+    is_mapped = true;
+    return true;
+#else
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamsize n = in.tellg();
+    if (n <= 0) return false;
+
+    fallback.resize(size_t(n));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(fallback.data()), n)) {
+        fallback.clear();
+        return false;
+    }
+    bytes     = fallback.data();
+    length    = size_t(n);
+    is_mapped = false;
+    return true;
+#endif
+}
+
+void mapped_file::close()
+{
+#ifdef MAPPED_FILE_USE_MMAP
+    if (is_mapped && bytes != nullptr)
+        munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+    fallback.clear();
+    fallback.shrink_to_fit();
+    bytes     = nullptr;
+    length    = 0;
+    is_mapped = false;
+}
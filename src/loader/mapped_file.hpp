@@ -0,0 +1,33 @@
+#pragma once
+// mapped_file.hpp
+// Read-only view over a whole file. The file is memory-mapped on POSIX systems,
+// and read into a private buffer elsewhere, so callers only see data()/size().
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct mapped_file {
+    mapped_file() = default;
+    explicit mapped_file(std::string const& filename) { open(filename); }
+    ~mapped_file() { close(); }
+
+    mapped_file(mapped_file const&)            = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    /// Map `filename`. Returns false (and leaves the object closed) on failure.
+    bool open(std::string const& filename);
+    void close();
+
+    bool                 is_open() const { return bytes != nullptr; }
+    unsigned char const* data()    const { return bytes; }
+    size_t               size()    const { return length; }
+
+private:
+    unsigned char const*       bytes  = nullptr;
+    size_t                     length = 0;
+    bool                       is_mapped = false;   ///< true = mmap, false = fallback copy
+    std::vector<unsigned char> fallback;
+};
@@ -0,0 +1,292 @@
+#include "mesh_cache.hpp"
+#include "mapped_file.hpp"
+#include "mesh_optimizer.hpp"
+#include "../utils/timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+static_assert(sizeof(cgp::vec2)  ==  2*sizeof(float),    "vec2 must be tightly packed");
+static_assert(sizeof(cgp::vec3)  ==  3*sizeof(float),    "vec3 must be tightly packed");
+static_assert(sizeof(cgp::vec4)  ==  4*sizeof(float),    "vec4 must be tightly packed");
+static_assert(sizeof(cgp::uint3) ==  3*sizeof(uint32_t), "uint3 must be tightly packed");
+static_assert(sizeof(cgp::uint4) ==  4*sizeof(uint32_t), "uint4 must be tightly packed");
+static_assert(sizeof(cgp::mat4)  == 16*sizeof(float),    "mat4 must be tightly packed");
+static_assert(std::is_trivially_copyable<gltf_submesh>::value, "gltf_submesh is stored as raw bytes");
+static_assert(std::is_trivially_copyable<gltf_joint_rest>::value, "gltf_joint_rest is stored as raw bytes");
+static_assert(std::is_trivially_copyable<gltf_animation_clip>::value, "gltf_animation_clip is stored as raw bytes");
+static_assert(std::is_trivially_copyable<gltf_animation_channel>::value, "gltf_animation_channel is stored as raw bytes");
+
+static constexpr char     cache_magic[8] = { 'S','E','A','M','E','S','H','\0' };
+static constexpr uint64_t cache_alignment = 16;
+
+static uint64_t align_up(uint64_t x) { return (x + cache_alignment - 1) & ~(cache_alignment - 1); }
+
+
+/* -------------------------------------------------------------------------- */
+/*  Reading helpers                                                           */
+/* -------------------------------------------------------------------------- */
+namespace {
+
+struct cache_view {
+    mapped_file               file;
+    mesh_cache_header const*  header   = nullptr;
+    mesh_cache_section const* sections = nullptr;
+
+    /// Check magic, version and that every section lies inside the file
+    bool open(std::string const& path)
+    {
+        if (!file.open(path)) return false;
+        if (file.size() < sizeof(mesh_cache_header)) return false;
+
+        header = reinterpret_cast<mesh_cache_header const*>(file.data());
+        if (std::memcmp(header->magic, cache_magic, sizeof(cache_magic)) != 0) return false;
+        if (header->version != mesh_cache_version) return false;
+
+        uint64_t table_end = sizeof(mesh_cache_header)
+                           + uint64_t(header->section_count) * sizeof(mesh_cache_section);
+        if (table_end > file.size()) return false;
+        sections = reinterpret_cast<mesh_cache_section const*>(file.data() + sizeof(mesh_cache_header));
+
+        for (uint32_t k = 0; k < header->section_count; ++k) {
+            mesh_cache_section const& s = sections[k];
+            if (s.element_size == 0) return false;
+            if (s.offset > file.size()) return false;
+            if (s.count > (file.size() - s.offset) / s.element_size) return false;
+        }
+        return true;
+    }
+
+    mesh_cache_section const* find(mesh_cache_section_id id) const
+    {
+        for (uint32_t k = 0; k < header->section_count; ++k)
+            if (sections[k].id == uint32_t(id)) return &sections[k];
+        return nullptr;
+    }
+
+    /// Copy a whole section into `dst` (a std::vector of T). Missing section = empty.
+    template <typename T>
+    bool read(mesh_cache_section_id id, std::vector<T>& dst) const
+    {
+        mesh_cache_section const* s = find(id);
+        if (s == nullptr) { dst.clear(); return true; }
+        if (s->element_size != sizeof(T)) return false;
+        dst.resize(size_t(s->count));
+        if (s->count > 0)
+            std::memcpy(dst.data(), file.data() + s->offset, size_t(s->count) * sizeof(T));
+        return true;
+    }
+
+    std::vector<std::string> source_files() const
+    {
+        std::vector<std::string> names;
+        mesh_cache_section const* s = find(mesh_cache_section_id::source_files);
+        if (s == nullptr) return names;
+        char const* p   = reinterpret_cast<char const*>(file.data() + s->offset);
+        char const* end = p + s->count;
+        while (p < end) {
+            char const* z = std::find(p, end, '\0');
+            if (z > p) names.emplace_back(p, z);
+            p = z + 1;
+        }
+        return names;
+    }
+};
+
+/// Cache newer than the .gltf and every listed source file
+bool is_newer_than_sources(std::string const& gltf_file, cache_view const& view)
+{
+    std::error_code ec;
+    auto cache_time = fs::last_write_time(mesh_cache_path(gltf_file), ec);
+    if (ec) return false;
+
+    auto gltf_time = fs::last_write_time(gltf_file, ec);
+    if (ec || gltf_time > cache_time) return false;
+
+    fs::path const dir = fs::path(gltf_file).parent_path();
+    for (std::string const& dep : view.source_files()) {
+        auto t = fs::last_write_time(dir / dep, ec);
+        if (ec || t > cache_time) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+/*  Public API                                                                */
+/* -------------------------------------------------------------------------- */
+std::string mesh_cache_path(std::string const& gltf_file)
+{
+    return gltf_file + ".meshcache";
+}
+
+bool mesh_cache_is_fresh(std::string const& gltf_file)
+{
+    cache_view view;
+    return view.open(mesh_cache_path(gltf_file)) && is_newer_than_sources(gltf_file, view);
+}
+
+bool mesh_cache_load(std::string const& gltf_file, gltf_geometry_and_texture& out)
+{
+    cache_view view;
+    if (!view.open(mesh_cache_path(gltf_file)))  return false;
+    if (!is_newer_than_sources(gltf_file, view)) return false;
+
+    gltf_geometry_and_texture result;
+    bool ok = view.read(mesh_cache_section_id::position,     result.geom.position.data)
+           && view.read(mesh_cache_section_id::normal,       result.geom.normal.data)
+           && view.read(mesh_cache_section_id::uv,           result.geom.uv.data)
+           && view.read(mesh_cache_section_id::connectivity, result.geom.connectivity.data)
+           && view.read(mesh_cache_section_id::joint_index,  result.joint_index.data)
+           && view.read(mesh_cache_section_id::joint_weight, result.joint_weight.data)
+           && view.read(mesh_cache_section_id::inverse_bind, result.inverse_bind)
+           && view.read(mesh_cache_section_id::joint_node,   result.joint_node)
+           && view.read(mesh_cache_section_id::submeshes,    result.submeshes)
+           && view.read(mesh_cache_section_id::lod_submeshes, result.lod_submeshes)
+           && view.read(mesh_cache_section_id::joint_parent, result.joint_parent)
+           && view.read(mesh_cache_section_id::joint_rest,   result.joint_rest)
+           && view.read(mesh_cache_section_id::animation_clips,    result.animations.clips)
+           && view.read(mesh_cache_section_id::animation_channels, result.animations.channels)
+           && view.read(mesh_cache_section_id::animation_times,    result.animations.times)
+           && view.read(mesh_cache_section_id::animation_values,   result.animations.values)
+           && view.read(mesh_cache_section_id::animation_packed,   result.animations.packed);
+    std::vector<cgp::mat4> base;
+    ok = ok && view.read(mesh_cache_section_id::skeleton_base, base);
+    if (!ok || result.submeshes.empty()) return false;
+    if (!base.empty()) result.skeleton_base = base[0];
+
+    result.source_files = view.source_files();
+    result.geom.fill_empty_field();
+    out = std::move(result);
+    return true;
+}
+
+void mesh_cache_write(std::string const& gltf_file, gltf_geometry_and_texture const& data)
+{
+    std::string names;
+    for (std::string const& f : data.source_files) {
+        names += f;
+        names += '\0';
+    }
+
+    struct payload { mesh_cache_section_id id; uint32_t element_size; uint64_t count; void const* bytes; };
+    payload const payloads[] = {
+        { mesh_cache_section_id::position,     sizeof(cgp::vec3),  data.geom.position.size(),     data.geom.position.data.data() },
+        { mesh_cache_section_id::normal,       sizeof(cgp::vec3),  data.geom.normal.size(),       data.geom.normal.data.data() },
+        { mesh_cache_section_id::uv,           sizeof(cgp::vec2),  data.geom.uv.size(),           data.geom.uv.data.data() },
+        { mesh_cache_section_id::connectivity, sizeof(cgp::uint3), data.geom.connectivity.size(), data.geom.connectivity.data.data() },
+        { mesh_cache_section_id::joint_index,  sizeof(cgp::uint4), data.joint_index.size(),       data.joint_index.data.data() },
+        { mesh_cache_section_id::joint_weight, sizeof(cgp::vec4),  data.joint_weight.size(),      data.joint_weight.data.data() },
+        { mesh_cache_section_id::inverse_bind, sizeof(cgp::mat4),  data.inverse_bind.size(),      data.inverse_bind.data() },
+        { mesh_cache_section_id::joint_node,   sizeof(int32_t),    data.joint_node.size(),        data.joint_node.data() },
+        { mesh_cache_section_id::source_files, 1,                  names.size(),                  names.data() },
+        { mesh_cache_section_id::submeshes,    sizeof(gltf_submesh), data.submeshes.size(),       data.submeshes.data() },
+        { mesh_cache_section_id::lod_submeshes, sizeof(gltf_submesh), data.lod_submeshes.size(),  data.lod_submeshes.data() },
+        { mesh_cache_section_id::joint_parent, sizeof(int32_t),    data.joint_parent.size(),      data.joint_parent.data() },
+        { mesh_cache_section_id::joint_rest,   sizeof(gltf_joint_rest), data.joint_rest.size(),   data.joint_rest.data() },
+        { mesh_cache_section_id::skeleton_base, sizeof(cgp::mat4), data.joint_node.empty() ? 0u : 1u, &data.skeleton_base },
+        { mesh_cache_section_id::animation_clips,    sizeof(gltf_animation_clip),    data.animations.clips.size(),    data.animations.clips.data() },
+        { mesh_cache_section_id::animation_channels, sizeof(gltf_animation_channel), data.animations.channels.size(), data.animations.channels.data() },
+        { mesh_cache_section_id::animation_times,    sizeof(float),    data.animations.times.size(),  data.animations.times.data() },
+        { mesh_cache_section_id::animation_values,   sizeof(float),    data.animations.values.size(), data.animations.values.data() },
+        { mesh_cache_section_id::animation_packed,   sizeof(uint16_t), data.animations.packed.size(), data.animations.packed.data() },
+    };
+    constexpr uint32_t n_section = uint32_t(sizeof(payloads) / sizeof(payloads[0]));
+    static_assert(sizeof(int) == sizeof(int32_t), "joint_node and joint_parent are stored as int32");
+
+    mesh_cache_header header;
+    std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version       = mesh_cache_version;
+    header.section_count = n_section;
+
+    mesh_cache_section table[n_section];
+    uint64_t offset = align_up(sizeof(mesh_cache_header) + sizeof(table));
+    for (uint32_t k = 0; k < n_section; ++k) {
+        table[k].id           = uint32_t(payloads[k].id);
+        table[k].element_size = payloads[k].element_size;
+        table[k].offset       = offset;
+        table[k].count        = payloads[k].count;
+        offset = align_up(offset + payloads[k].count * payloads[k].element_size);
+    }
+
+    // write next to the target and rename, so a crash never leaves a half cache
+    std::string const path = mesh_cache_path(gltf_file);
+    std::string const tmp  = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("Cannot write mesh cache " + tmp);
+
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const*>(table),   sizeof(table));
+
+        char const zeros[cache_alignment] = {};
+        for (uint32_t k = 0; k < n_section; ++k) {
+            uint64_t pos = uint64_t(out.tellp());
+            out.write(zeros, std::streamsize(table[k].offset - pos));
+            out.write(static_cast<char const*>(payloads[k].bytes),
+                      std::streamsize(payloads[k].count * payloads[k].element_size));
+        }
+        if (!out)
+            throw std::runtime_error("Error while writing mesh cache " + tmp);
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec)
+        throw std::runtime_error("Cannot move " + tmp + " to " + path + ": " + ec.message());
+}
+
+void mesh_cache_bake(std::vector<std::string> const& gltf_files)
+{
+    for (std::string const& file : gltf_files)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        gltf_geometry_and_texture data = mesh_load_file_gltf(file, /*load_texture=*/false);
+        double parse_ms = elapsed_ms(t0);
+
+        mesh_cache_write(file, data);
+
+        t0 = std::chrono::steady_clock::now();
+        gltf_geometry_and_texture cached;
+        bool ok = mesh_cache_load(file, cached);
+        double cache_ms = elapsed_ms(t0);
+
+        if (!ok)
+            throw std::runtime_error("Freshly baked mesh cache cannot be read back: " + mesh_cache_path(file));
+
+        // LOD 0 is the start of the index buffer, the other levels follow
+        size_t lod0 = 0;
+        for (gltf_submesh const& sub : data.submeshes) lod0 += sub.triangle_count;
+        cgp::numarray<cgp::uint3> lod0_triangles;
+        lod0_triangles.data.assign(data.geom.connectivity.data.begin(), data.geom.connectivity.data.begin() + lod0);
+        vertex_cache_stats const vcache = analyze_vertex_cache(lod0_triangles, data.geom.position.size());
+
+        std::string lods = std::to_string(lod0);
+        for (size_t k = 0; k < data.lod_submeshes.size(); k += data.submeshes.size()) {
+            size_t level = 0;
+            for (size_t s = k; s < k + data.submeshes.size(); ++s) level += data.lod_submeshes[s].triangle_count;
+            lods += " / " + std::to_string(level);
+        }
+
+        std::cout << "[mesh_cache] " << file << "\n"
+                  << "    " << data.geom.position.size() << " vertices, "
+                  << lod0 << " triangles in "
+                  << data.submeshes.size() << " submesh(es), "
+                  << data.inverse_bind.size() << " joints\n"
+                  << "    LOD triangles : " << lods << "\n"
+                  << "    ACMR " << vcache.acmr << ", ATVR " << vcache.atvr << " (FIFO 16, LOD 0)\n"
+                  << "    glTF parse : " << parse_ms << " ms\n"
+                  << "    cache load : " << cache_ms << " ms\n";
+    }
+}
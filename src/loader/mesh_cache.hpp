@@ -0,0 +1,67 @@
+#pragma once
+// mesh_cache.hpp
+// Baked binary snapshot of a gltf_geometry_and_texture, stored next to the
+// asset as "<file>.meshcache". Loading it skips TinyGLTF entirely.
+//
+// Layout (little endian, every section 16-byte aligned so the file can be
+// used straight from a memory mapping):
+//
+//   mesh_cache_header
+//   mesh_cache_section[section_count]
+//   section payloads ...
+//
+// The texture is *not* cached: actors bind their own texture file anyway.
+
+#include <cstdint>
+#include <string>
+#include "gltf_loader.hpp"
+
+constexpr uint32_t mesh_cache_version = 6;   // 2: submesh table, 3: optimized order, 4: LODs, 5: skeleton, 6: clips
+
+struct mesh_cache_header {
+    char     magic[8];        ///< "SEAMESH\0"
+    uint32_t version;         ///< mesh_cache_version
+    uint32_t section_count;
+};
+
+enum class mesh_cache_section_id : uint32_t {
+    position = 1, normal, uv, connectivity,
+    joint_index, joint_weight, inverse_bind, joint_node,
+    source_files,             ///< '\0'-separated list, relative to the .gltf
+    submeshes,                ///< gltf_submesh draw ranges
+    lod_submeshes,            ///< gltf_submesh ranges of LOD 1, 2 …
+    joint_parent,             ///< int32 per joint, -1 for the roots
+    joint_rest,               ///< gltf_joint_rest per joint
+    skeleton_base,            ///< one mat4 (none without a skin)
+    animation_clips,          ///< gltf_animation_set, pool by pool
+    animation_channels,
+    animation_times,
+    animation_values,
+    animation_packed
+};
+
+struct mesh_cache_section {
+    uint32_t id;              ///< mesh_cache_section_id
+    uint32_t element_size;    ///< bytes per element, checked on load
+    uint64_t offset;          ///< from the start of the file
+    uint64_t count;           ///< number of elements
+};
+
+/// "<gltf_file>.meshcache"
+std::string mesh_cache_path(std::string const& gltf_file);
+
+/// True if the cache exists, has the current version and is newer than the
+/// .gltf and every buffer it was baked from.
+bool mesh_cache_is_fresh(std::string const& gltf_file);
+
+/// Fill `out` from a fresh cache. Returns false if there is none (or it is
+/// stale/corrupt), in which case `out` is left untouched.
+bool mesh_cache_load(std::string const& gltf_file, gltf_geometry_and_texture& out);
+
+/// Write the cache for `gltf_file`.
+/// @throw std::runtime_error if the file cannot be written.
+void mesh_cache_write(std::string const& gltf_file, gltf_geometry_and_texture const& data);
+
+/// Parse every glTF of the list, write its cache and print the load time
+/// with and without it. Needs no OpenGL context.
+void mesh_cache_bake(std::vector<std::string> const& gltf_files);
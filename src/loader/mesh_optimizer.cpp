@@ -0,0 +1,226 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+using cgp::uint3;
+using cgp::vec3;
+
+/// A cluster is only closed at a Tipsify dead end once it has this many triangles
+static constexpr size_t min_cluster_triangles = 64;
+
+
+/* -------------------------------------------------------------------------- */
+/*  Tipsify                                                                   */
+/* -------------------------------------------------------------------------- */
+/**
+ * New order of the `tri_count` triangles (indices into `tris`), fanning
+ * around the vertex most likely to still be in a cache of `cache_size`.
+ * `cluster_starts` receives the positions (in the new order) where Tipsify
+ * had to restart from a dead end.
+ */
+static std::vector<uint32_t> tipsify(uint3 const* tris, size_t tri_count, size_t vertex_count,
+                                     int cache_size, std::vector<size_t>& cluster_starts)
+{
+    std::vector<uint32_t> order;
+    if (tri_count == 0) return order;
+    order.reserve(tri_count);
+
+    // vertex → triangles adjacency, compressed rows
+    std::vector<uint32_t> first(vertex_count + 1, 0);
+    for (size_t t = 0; t < tri_count; ++t)
+        for (int c = 0; c < 3; ++c) ++first[tris[t][c] + 1];
+    for (size_t v = 0; v < vertex_count; ++v) first[v + 1] += first[v];
+
+    std::vector<uint32_t> adjacency(3 * tri_count);
+    std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+    for (size_t t = 0; t < tri_count; ++t)
+        for (int c = 0; c < 3; ++c) adjacency[fill[tris[t][c]]++] = uint32_t(t);
+
+    std::vector<int>      live(vertex_count);            // triangles not emitted yet
+    for (size_t v = 0; v < vertex_count; ++v) live[v] = int(first[v + 1] - first[v]);
+    std::vector<int>      stamp(vertex_count, 0);        // time the vertex entered the cache
+    std::vector<char>     emitted(tri_count, 0);
+    std::vector<uint32_t> dead_end;                      // recently used vertices
+    std::vector<uint32_t> candidates;
+    dead_end.reserve(3 * tri_count);
+
+    int    time   = cache_size + 1;
+    size_t cursor = 0;                                   // for restarts when everything is dead
+    size_t cluster_size = 0;
+    int64_t fan = tris[0][0];
+    cluster_starts.assign(1, 0);
+
+    while (fan >= 0)
+    {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t a = first[fan]; a < first[fan + 1]; ++a) {
+            uint32_t const t = adjacency[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+            order.push_back(t);
+            ++cluster_size;
+            for (int c = 0; c < 3; ++c) {
+                uint32_t const v = tris[t][c];
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - stamp[v] > cache_size)
+                    stamp[v] = time++;
+            }
+        }
+
+        // next fanning vertex: the one-ring vertex that stays longest in the cache
+        int64_t best = -1;
+        int best_priority = -1;
+        for (uint32_t v : candidates) {
+            if (live[v] <= 0) continue;
+            int priority = 0;
+            if (time - stamp[v] + 2 * live[v] <= cache_size)
+                priority = time - stamp[v];
+            if (priority > best_priority) { best_priority = priority; best = v; }
+        }
+
+        if (best < 0) {   // dead end: a recent vertex, else the next live one
+            while (!dead_end.empty() && best < 0) {
+                uint32_t const v = dead_end.back();
+                dead_end.pop_back();
+                if (live[v] > 0) best = v;
+            }
+            while (best < 0 && cursor < vertex_count) {
+                if (live[cursor] > 0) best = int64_t(cursor);
+                else ++cursor;
+            }
+            if (best >= 0 && cluster_size >= min_cluster_triangles) {
+                cluster_starts.push_back(order.size());
+                cluster_size = 0;
+            }
+        }
+        fan = best;
+    }
+    return order;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Overdraw: clusters facing outward first                                   */
+/* -------------------------------------------------------------------------- */
+static void sort_clusters_outside_in(uint3 const* tris, cgp::numarray<vec3> const& position,
+                                     std::vector<uint32_t>& order,
+                                     std::vector<size_t> const& cluster_starts)
+{
+    struct cluster { size_t begin, end; vec3 centroid, normal; float area; float key; };
+    std::vector<cluster> clusters;
+
+    vec3  mesh_centroid = { 0, 0, 0 };
+    float mesh_area     = 0;
+    for (size_t k = 0; k < cluster_starts.size(); ++k) {
+        cluster c{ cluster_starts[k], k + 1 < cluster_starts.size() ? cluster_starts[k + 1] : order.size(),
+                   { 0, 0, 0 }, { 0, 0, 0 }, 0, 0 };
+        for (size_t i = c.begin; i < c.end; ++i) {
+            uint3 const& t = tris[order[i]];
+            vec3 const n    = cross(position[t[1]] - position[t[0]], position[t[2]] - position[t[0]]);
+            float const a   = 0.5f * norm(n);
+            c.normal   += n;
+            c.centroid += a * (position[t[0]] + position[t[1]] + position[t[2]]) / 3.0f;
+            c.area     += a;
+        }
+        mesh_centroid += c.centroid;
+        mesh_area     += c.area;
+        if (c.area > 0) c.centroid /= c.area;
+        clusters.push_back(c);
+    }
+    if (mesh_area > 0) mesh_centroid /= mesh_area;
+
+    for (cluster& c : clusters) {
+        float const n = norm(c.normal);
+        c.key = n > 0 ? dot(c.centroid - mesh_centroid, c.normal / n) : 0.0f;
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](cluster const& a, cluster const& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(order.size());
+    for (cluster const& c : clusters)
+        sorted.insert(sorted.end(), order.begin() + c.begin, order.begin() + c.end);
+    order.swap(sorted);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Public API                                                                */
+/* -------------------------------------------------------------------------- */
+vertex_cache_stats analyze_vertex_cache(cgp::numarray<uint3> const& triangles,
+                                        size_t vertex_count, int cache_size)
+{
+    vertex_cache_stats stats;
+    if (triangles.size() == 0) return stats;
+
+    // FIFO: a vertex is evicted after `cache_size` later insertions
+    std::vector<uint64_t> inserted(vertex_count, 0);
+    uint64_t insertions = 0;
+    size_t   misses     = 0, used = 0;
+    for (uint3 const& t : triangles.data)
+        for (int c = 0; c < 3; ++c) {
+            uint32_t const v = t[c];
+            if (inserted[v] == 0) ++used;
+            if (inserted[v] == 0 || insertions - inserted[v] >= uint64_t(cache_size)) {
+                inserted[v] = ++insertions;
+                ++misses;
+            }
+        }
+    stats.acmr = float(misses) / float(triangles.size());
+    stats.atvr = float(misses) / float(used);
+    return stats;
+}
+
+void mesh_optimize(gltf_geometry_and_texture& data, int cache_size)
+{
+    std::vector<uint3>& tris     = data.geom.connectivity.data;
+    size_t const        n_vertex = data.geom.position.size();
+
+    /* ---- triangles: Tipsify + overdraw order, submesh by submesh --------- */
+    std::vector<gltf_submesh> ranges = data.submeshes;
+    ranges.insert(ranges.end(), data.lod_submeshes.begin(), data.lod_submeshes.end());
+
+    std::vector<uint3> reordered(tris);
+    for (gltf_submesh const& sub : ranges) {
+        uint3 const* range = tris.data() + sub.first_triangle;
+        std::vector<size_t>   cluster_starts;
+        std::vector<uint32_t> order = tipsify(range, sub.triangle_count, n_vertex,
+                                              cache_size, cluster_starts);
+        sort_clusters_outside_in(range, data.geom.position, order, cluster_starts);
+        for (size_t k = 0; k < order.size(); ++k)
+            reordered[sub.first_triangle + k] = range[order[k]];
+    }
+    tris.swap(reordered);
+
+    /* ---- vertices: first-use order (LOD 0 first), unused ones dropped ---- */
+    constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(n_vertex, unused);
+    uint32_t next = 0;
+    for (uint3& t : tris)
+        for (int c = 0; c < 3; ++c) {
+            uint32_t& v = t[c];
+            if (remap[v] == unused) remap[v] = next++;
+            v = remap[v];
+        }
+
+    auto permute = [&](auto& array) {
+        if (array.size() != n_vertex) return;
+        std::remove_reference_t<decltype(array.data)> out(next);
+        for (size_t v = 0; v < n_vertex; ++v)
+            if (remap[v] != unused) out[remap[v]] = array.data[v];
+        array.data.swap(out);
+    };
+    permute(data.geom.position);
+    permute(data.geom.normal);
+    permute(data.geom.color);
+    permute(data.geom.uv);
+    permute(data.joint_index);
+    permute(data.joint_weight);
+}
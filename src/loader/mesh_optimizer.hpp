@@ -0,0 +1,25 @@
+#pragma once
+// mesh_optimizer.hpp
+// Reordering of a merged glTF mesh for the GPU, run by the loader (and so
+// baked into the mesh cache):
+//   1. Tipsify (Sander, Nehab, Barczak 2007) triangle order inside each
+//      submesh (and LOD range), for the post-transform vertex cache
+//   2. the clusters Tipsify leaves at its dead ends are sorted outside-in
+//      (view-independent overdraw order of the same paper)
+//   3. vertices renumbered in first-use order for fetch locality, the
+//      vertices no triangle uses are dropped
+
+#include <cstddef>
+#include "gltf_loader.hpp"
+
+struct vertex_cache_stats {
+    float acmr = 0;   ///< average cache miss ratio: transformed vertices per triangle (0.5 .. 3)
+    float atvr = 0;   ///< average transform to vertex ratio: transformed per used vertex (>= 1)
+};
+
+/// Simulate a FIFO post-transform cache of `cache_size` entries over `triangles`
+vertex_cache_stats analyze_vertex_cache(cgp::numarray<cgp::uint3> const& triangles,
+                                        size_t vertex_count, int cache_size = 16);
+
+/// Reorder triangles (per submesh and LOD range) and vertices of `data` in place
+void mesh_optimize(gltf_geometry_and_texture& data, int cache_size = 16);
@@ -0,0 +1,253 @@
+#include "mesh_simplify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+
+using cgp::uint3;
+using cgp::vec3;
+
+/// Skin penalty, in squared bounding box diagonals per unit of squared weight difference
+static constexpr double skin_penalty = 1e-2;
+/// A collapse is refused when a triangle normal turns by more than ~78 degrees
+static constexpr float  min_normal_cosine = 0.2f;
+
+
+namespace {
+
+/// Symmetric 4x4 error quadric: p^T A p + 2 b.p + c
+struct quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0;
+
+    static quadric plane(vec3 const& n, double d, double w)
+    {
+        quadric q;
+        q.a00 = w * n.x * n.x; q.a01 = w * n.x * n.y; q.a02 = w * n.x * n.z;
+        q.a11 = w * n.y * n.y; q.a12 = w * n.y * n.z; q.a22 = w * n.z * n.z;
+        q.b0  = w * n.x * d;   q.b1  = w * n.y * d;   q.b2  = w * n.z * d;
+        q.c   = w * d * d;
+        return q;
+    }
+
+    quadric& operator+=(quadric const& o)
+    {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+        b0 += o.b0; b1 += o.b1; b2 += o.b2; c += o.c;
+        return *this;
+    }
+
+    double error(vec3 const& p) const
+    {
+        double const x = p.x, y = p.y, z = p.z;
+        double const e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z
+                       + a11 * y * y + 2 * a12 * y * z + a22 * z * z
+                       + 2 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(e, 0.0);
+    }
+};
+
+struct collapse {
+    double   cost;
+    uint32_t from, to;
+    uint32_t version_from, version_to;
+    bool operator>(collapse const& o) const { return cost > o.cost; }
+};
+
+uint64_t edge_key(uint32_t a, uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+/// Squared distance between two sparse 4-joint weight vectors
+double weight_distance(cgp::numarray<cgp::uint4> const& joints, cgp::numarray<cgp::vec4> const& weights,
+                       uint32_t a, uint32_t b)
+{
+    if (joints.size() <= std::max(a, b) || weights.size() <= std::max(a, b)) return 0;
+    uint32_t id[8];
+    double   diff[8];
+    int      n = 0;
+    auto accumulate = [&](uint32_t v, double sign) {
+        for (int k = 0; k < 4; ++k) {
+            int i = 0;
+            while (i < n && id[i] != joints[v][k]) ++i;
+            if (i == n) { id[n] = joints[v][k]; diff[n++] = 0; }
+            diff[i] += sign * weights[v][k];
+        }
+    };
+    accumulate(a, +1);
+    accumulate(b, -1);
+    double d = 0;
+    for (int i = 0; i < n; ++i) d += diff[i] * diff[i];
+    return d;
+}
+
+} // namespace
+
+
+std::vector<std::vector<uint3>> simplify_progressive(
+    cgp::numarray<vec3>       const& position,
+    cgp::numarray<cgp::uint4> const& joints,
+    cgp::numarray<cgp::vec4>  const& weights,
+    std::vector<uint3>        const& triangles,
+    std::vector<size_t>       const& targets)
+{
+    size_t const n_vertex = position.size();
+    std::vector<uint3> tris = triangles;
+    std::vector<char>  alive(tris.size(), 1);
+    size_t live = tris.size();
+
+    std::vector<std::vector<uint32_t>> incident(n_vertex);   // may list dead triangles
+    std::vector<quadric>  Q(n_vertex);
+    std::vector<char>     locked(n_vertex, 0), removed(n_vertex, 0);
+    std::vector<uint32_t> version(n_vertex, 0);
+
+    vec3 pmin = position[tris.empty() ? 0 : tris[0][0]], pmax = pmin;
+    std::unordered_map<uint64_t, int> edge_use;
+    for (uint32_t t = 0; t < tris.size(); ++t) {
+        uint3 const& f = tris[t];
+        vec3 const n = cross(position[f[1]] - position[f[0]], position[f[2]] - position[f[0]]);
+        double const area2 = norm(n);
+        vec3 const unit = area2 > 0 ? n / float(area2) : vec3{ 0, 0, 0 };
+        quadric const q = quadric::plane(unit, -double(dot(unit, position[f[0]])), 0.5 * area2);
+        for (int c = 0; c < 3; ++c) {
+            incident[f[c]].push_back(t);
+            Q[f[c]] += q;
+            ++edge_use[edge_key(f[c], f[(c + 1) % 3])];
+            for (int k = 0; k < 3; ++k) {
+                pmin[k] = std::min(pmin[k], position[f[c]][k]);
+                pmax[k] = std::max(pmax[k], position[f[c]][k]);
+            }
+        }
+    }
+    for (auto const& e : edge_use)
+        if (e.second != 2) {                                    // border, seam or non-manifold
+            locked[uint32_t(e.first >> 32)] = 1;
+            locked[uint32_t(e.first)]       = 1;
+        }
+    double const diag2 = double(dot(pmax - pmin, pmax - pmin));
+
+    std::priority_queue<collapse, std::vector<collapse>, std::greater<collapse>> heap;
+    auto push = [&](uint32_t from, uint32_t to) {
+        if (locked[from]) return;
+        quadric q = Q[from];
+        q += Q[to];
+        double const cost = q.error(position[to])
+                          + skin_penalty * diag2 * weight_distance(joints, weights, from, to);
+        heap.push({ cost, from, to, version[from], version[to] });
+    };
+    auto neighbours = [&](uint32_t v, std::vector<uint32_t>& out) {
+        out.clear();
+        for (uint32_t t : incident[v]) {
+            if (!alive[t]) continue;
+            for (int c = 0; c < 3; ++c)
+                if (tris[t][c] != v) out.push_back(tris[t][c]);
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+
+    for (uint3 const& f : tris)
+        for (int c = 0; c < 3; ++c) {
+            push(f[c], f[(c + 1) % 3]);
+            push(f[(c + 1) % 3], f[c]);
+        }
+
+    std::vector<std::vector<uint3>> result;
+    auto snapshot = [&]() {
+        std::vector<uint3> out;
+        out.reserve(live);
+        for (size_t t = 0; t < tris.size(); ++t)
+            if (alive[t]) out.push_back(tris[t]);
+        result.push_back(std::move(out));
+    };
+
+    std::vector<uint32_t> ring_from, ring_to, common;
+    while (result.size() < targets.size())
+    {
+        if (live <= targets[result.size()]) { snapshot(); continue; }
+        if (heap.empty()) break;
+
+        collapse const e = heap.top();
+        heap.pop();
+        uint32_t const a = e.from, b = e.to;
+        if (removed[a] || removed[b] || version[a] != e.version_from || version[b] != e.version_to)
+            continue;
+
+        // link condition: an interior edge shares exactly its two opposite vertices
+        neighbours(a, ring_from);
+        neighbours(b, ring_to);
+        common.clear();
+        std::set_intersection(ring_from.begin(), ring_from.end(), ring_to.begin(), ring_to.end(),
+                              std::back_inserter(common));
+        if (common.size() != 2) continue;
+
+        // no triangle around `a` may flip or collapse once `a` moves onto `b`
+        bool valid = true;
+        for (uint32_t t : incident[a]) {
+            if (!alive[t]) continue;
+            uint3 f = tris[t];
+            if (f[0] == b || f[1] == b || f[2] == b) continue;
+            vec3 const n0 = cross(position[f[1]] - position[f[0]], position[f[2]] - position[f[0]]);
+            for (int c = 0; c < 3; ++c) if (f[c] == a) f[c] = b;
+            vec3 const n1 = cross(position[f[1]] - position[f[0]], position[f[2]] - position[f[0]]);
+            float const l0 = norm(n0), l1 = norm(n1);
+            if (l1 <= 0 || dot(n0, n1) < min_normal_cosine * l0 * l1) { valid = false; break; }
+        }
+        if (!valid) continue;
+
+        // collapse a → b
+        for (uint32_t t : incident[a]) {
+            if (!alive[t]) continue;
+            uint3& f = tris[t];
+            if (f[0] == b || f[1] == b || f[2] == b) { alive[t] = 0; --live; continue; }
+            for (int c = 0; c < 3; ++c) if (f[c] == a) f[c] = b;
+            incident[b].push_back(t);
+        }
+        incident[a].clear();
+        removed[a] = 1;
+        Q[b] += Q[a];
+
+        // every collapse from or onto b changed cost (and a's edges are b's now)
+        neighbours(b, ring_to);
+        ++version[b];
+        for (uint32_t n : ring_to) {
+            push(b, n);
+            push(n, b);
+        }
+    }
+    while (result.size() < targets.size())
+        snapshot();
+    return result;
+}
+
+
+void mesh_build_lods(gltf_geometry_and_texture& data, std::vector<float> const& ratios)
+{
+    std::vector<uint3>& tris = data.geom.connectivity.data;
+    std::vector<gltf_submesh> const lod0 = data.submeshes;
+    std::vector<std::vector<std::vector<uint3>>> levels;       // [submesh][ratio]
+
+    for (gltf_submesh const& sub : lod0) {
+        std::vector<uint3> range(tris.begin() + sub.first_triangle,
+                                 tris.begin() + sub.first_triangle + sub.triangle_count);
+        std::vector<size_t> targets;
+        for (float r : ratios)
+            targets.push_back(size_t(std::lround(double(r) * sub.triangle_count)));
+        levels.push_back(simplify_progressive(data.geom.position, data.joint_index,
+                                              data.joint_weight, range, targets));
+    }
+
+    data.lod_submeshes.clear();
+    for (size_t level = 0; level < ratios.size(); ++level)
+        for (size_t s = 0; s < lod0.size(); ++s) {
+            gltf_submesh sub = lod0[s];
+            std::vector<uint3> const& range = levels[s][level];
+            sub.first_triangle = uint32_t(tris.size());
+            sub.triangle_count = uint32_t(range.size());
+            tris.insert(tris.end(), range.begin(), range.end());
+            data.lod_submeshes.push_back(sub);
+        }
+}
@@ -0,0 +1,33 @@
+#pragma once
+// mesh_simplify.hpp
+// Level-of-detail chain of a merged glTF mesh by quadric error edge collapse
+// (Garland & Heckbert 1997), restricted to collapses onto existing vertices:
+// every LOD indexes the LOD 0 vertex buffer, so normals, uv and skin weights
+// stay exact and one VAO serves all levels.
+//   - vertices on open edges are locked: mesh borders, and the uv / normal
+//     seams, which are split vertices in the index buffer
+//   - a collapse that flips a triangle or breaks the link condition is refused
+//   - the cost adds a penalty for merging vertices with different skin
+//     weights, so that joints keep their silhouette longest
+
+#include <cstddef>
+#include <vector>
+#include "gltf_loader.hpp"
+
+/**
+ * Simplify `triangles` (indices into `position`) progressively and return one
+ * triangle list per entry of `targets`, which must be decreasing. A target
+ * that cannot be reached (everything left is locked) gets the coarsest mesh.
+ * `joints` / `weights` may be empty (no skin penalty).
+ */
+std::vector<std::vector<cgp::uint3>> simplify_progressive(
+    cgp::numarray<cgp::vec3>  const& position,
+    cgp::numarray<cgp::uint4> const& joints,
+    cgp::numarray<cgp::vec4>  const& weights,
+    std::vector<cgp::uint3>   const& triangles,
+    std::vector<size_t>       const& targets);
+
+/// Append LODs to `data`: one level per ratio of the LOD 0 triangle count,
+/// submesh by submesh (see gltf_geometry_and_texture::lod_submeshes)
+void mesh_build_lods(gltf_geometry_and_texture& data,
+                     std::vector<float> const& ratios = { 0.5f, 0.25f, 0.125f });
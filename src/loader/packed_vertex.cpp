@@ -0,0 +1,180 @@
+#include "packed_vertex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using cgp::vec2;
+using cgp::vec3;
+using cgp::vec4;
+
+static uint16_t to_unorm16(float x)
+{
+    return uint16_t(std::lround(std::clamp(x, 0.0f, 1.0f) * 65535.0f));
+}
+
+static int16_t to_snorm16(float x)
+{
+    return int16_t(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767.0f));
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Half floats (round to nearest, subnormals kept, overflow to infinity)     */
+/* -------------------------------------------------------------------------- */
+uint16_t float_to_half(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    uint32_t const sign = (x >> 16) & 0x8000u;
+    uint32_t const abs  = x & 0x7FFFFFFFu;
+
+    if (abs >= 0x7F800000u)                           // inf / nan
+        return uint16_t(sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0u));
+    if (abs >= 0x477FF000u)                           // rounds above 65504
+        return uint16_t(sign | 0x7C00u);
+    if (abs < 0x38800000u)                            // half subnormal: multiple of 2^-24 (exact scaling)
+        return uint16_t(sign | uint32_t(std::nearbyint(std::abs(f) * 16777216.0f)));
+    // normal: rebias the exponent (127 → 15), round the 13 dropped bits to nearest even
+    uint32_t const rebased = abs - 0x38000000u;
+    uint32_t const rounded = (rebased + 0x0FFFu + ((rebased >> 13) & 1u)) >> 13;
+    return uint16_t(sign | rounded);
+}
+
+float half_to_float(uint16_t h)
+{
+    uint32_t const sign     = uint32_t(h & 0x8000u) << 16;
+    uint32_t const exponent = (h >> 10) & 0x1Fu;
+    uint32_t const mantissa = h & 0x3FFu;
+
+    float f;
+    if (exponent == 0)
+        f = std::ldexp(float(mantissa), -24);
+    else if (exponent == 31)
+        f = mantissa ? NAN : INFINITY;
+    else
+        f = std::ldexp(float(mantissa | 0x400u), int(exponent) - 25);
+    return sign ? -f : f;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Octahedral normals                                                        */
+/* -------------------------------------------------------------------------- */
+cgp::vec2 octahedral_encode(vec3 const& n)
+{
+    float const l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 == 0) return { 0, 0 };
+    vec2 e = { n.x / l1, n.y / l1 };
+    if (n.z < 0) {
+        vec2 const folded = { (1.0f - std::abs(e.y)) * (e.x >= 0 ? 1.0f : -1.0f),
+                              (1.0f - std::abs(e.x)) * (e.y >= 0 ? 1.0f : -1.0f) };
+        e = folded;
+    }
+    return e;
+}
+
+cgp::vec3 octahedral_decode(vec2 const& e)
+{
+    vec3 n = { e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y) };
+    float const t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0 ? -t : t;
+    n.y += n.y >= 0 ? -t : t;
+    return normalize(n);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Packing                                                                   */
+/* -------------------------------------------------------------------------- */
+packed_skin_mesh pack_skin_vertices(cgp::mesh const& geom,
+                                    cgp::numarray<cgp::uint4> const& joints,
+                                    cgp::numarray<cgp::vec4> const& weights)
+{
+    size_t const n = geom.position.size();
+    packed_skin_mesh out;
+    out.vertices.resize(n);
+    if (n == 0) return out;
+
+    vec3 pmin = geom.position[0], pmax = geom.position[0];
+    for (size_t v = 1; v < n; ++v)
+        for (int c = 0; c < 3; ++c) {
+            pmin[c] = std::min(pmin[c], geom.position[v][c]);
+            pmax[c] = std::max(pmax[c], geom.position[v][c]);
+        }
+    out.position_offset = pmin;
+    for (int c = 0; c < 3; ++c)
+        out.position_scale[c] = pmax[c] > pmin[c] ? pmax[c] - pmin[c] : 1.0f;
+
+    bool const skinned = joints.size() == n && weights.size() == n;
+    for (size_t v = 0; v < n; ++v)
+    {
+        packed_skin_vertex& p = out.vertices[v];
+
+        for (int c = 0; c < 3; ++c)
+            p.position[c] = to_unorm16((geom.position[v][c] - pmin[c]) / out.position_scale[c]);
+
+        vec2 const e = v < geom.normal.size() ? octahedral_encode(geom.normal[v]) : vec2{ 0, 0 };
+        p.normal[0] = to_snorm16(e.x);
+        p.normal[1] = to_snorm16(e.y);
+
+        vec2 const uv = v < geom.uv.size() ? geom.uv[v] : vec2{ 0, 0 };
+        p.uv[0] = float_to_half(uv.x);
+        p.uv[1] = float_to_half(uv.y);
+
+        if (!skinned) {
+            std::fill(p.joints, p.joints + 4, uint8_t(0));
+            p.weights[0] = 65535;
+            std::fill(p.weights + 1, p.weights + 4, uint16_t(0));
+            continue;
+        }
+
+        vec4 w = weights[v];
+        float const sum = w.x + w.y + w.z + w.w;
+        w = sum > 0 ? w * (1.0f / sum) : vec4{ 1, 0, 0, 0 };
+
+        int total = 0, largest = 0;
+        for (int c = 0; c < 4; ++c) {
+            if (joints[v][c] > 255)
+                throw std::runtime_error("pack_skin_vertices: joint " + std::to_string(joints[v][c])
+                                         + " does not fit the 8-bit joint index");
+            p.joints[c]  = uint8_t(joints[v][c]);
+            p.weights[c] = to_unorm16(w[c]);
+            total += p.weights[c];
+            if (p.weights[c] > p.weights[largest]) largest = c;
+        }
+        p.weights[largest] = uint16_t(p.weights[largest] + (65535 - total));   // exact partition of unity
+    }
+    return out;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Unpacking (what the vertex shader computes)                               */
+/* -------------------------------------------------------------------------- */
+cgp::vec3 unpack_position(packed_skin_mesh const& mesh, packed_skin_vertex const& v)
+{
+    vec3 p;
+    for (int c = 0; c < 3; ++c)
+        p[c] = mesh.position_offset[c] + mesh.position_scale[c] * (v.position[c] / 65535.0f);
+    return p;
+}
+
+cgp::vec3 unpack_normal(packed_skin_vertex const& v)
+{
+    return octahedral_decode({ std::max(v.normal[0] / 32767.0f, -1.0f),
+                               std::max(v.normal[1] / 32767.0f, -1.0f) });
+}
+
+cgp::vec2 unpack_uv(packed_skin_vertex const& v)
+{
+    return { half_to_float(v.uv[0]), half_to_float(v.uv[1]) };
+}
+
+cgp::vec4 unpack_weights(packed_skin_vertex const& v)
+{
+    return { v.weights[0] / 65535.0f, v.weights[1] / 65535.0f,
+             v.weights[2] / 65535.0f, v.weights[3] / 65535.0f };
+}
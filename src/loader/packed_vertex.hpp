@@ -0,0 +1,56 @@
+#pragma once
+// packed_vertex.hpp
+// Compact interleaved vertex of the skinned actors: one 28-byte vertex in a
+// single VBO, instead of the 76 bytes spread over six float / uint32 streams
+// (CGP's position, normal, color, uv + JOINTS_0, WEIGHTS_0).
+//
+//   position  3 x unorm16  dequantized in the shader: offset + scale * p (+ 2 bytes padding)
+//   normal    2 x snorm16  octahedral encoding
+//   uv        2 x half
+//   joints    4 x uint8    (at most 256 joints)
+//   weights   4 x unorm16  summing to exactly 65535
+//
+// CPU side only (any thread); the VAO is set up in gpu_skin_helper.hpp.
+
+#include <cstdint>
+#include <vector>
+#include "cgp/cgp.hpp"
+
+struct packed_skin_vertex {
+    uint16_t position[4];   ///< [3] unused: keeps every attribute 4-byte aligned
+    int16_t  normal[2];
+    uint16_t uv[2];
+    uint8_t  joints[4];
+    uint16_t weights[4];
+};
+static_assert(sizeof(packed_skin_vertex) == 28, "packed_skin_vertex must be 28 bytes");
+
+/// Bytes per vertex of the float layout the packed one replaces
+constexpr size_t float_skin_vertex_bytes = 3 * sizeof(cgp::vec3) + sizeof(cgp::vec2)
+                                         + sizeof(cgp::uint4) + sizeof(cgp::vec4);
+
+struct packed_skin_mesh {
+    std::vector<packed_skin_vertex> vertices;
+    cgp::vec3 position_offset = { 0, 0, 0 };   ///< bounding box min
+    cgp::vec3 position_scale  = { 1, 1, 1 };   ///< bounding box size
+};
+
+/**
+ * Quantize `geom` (position, normal, uv) and its skin. Vertices without skin
+ * data (`joints` / `weights` shorter than the mesh) get joint 0, weight 1.
+ * @throw std::runtime_error if a joint index does not fit in 8 bits.
+ */
+packed_skin_mesh pack_skin_vertices(cgp::mesh const& geom,
+                                    cgp::numarray<cgp::uint4> const& joints,
+                                    cgp::numarray<cgp::vec4> const& weights);
+
+/* ---- encoders / decoders, the decoders mirror turtle.vert.glsl ---------- */
+uint16_t  float_to_half(float f);
+float     half_to_float(uint16_t h);
+cgp::vec2 octahedral_encode(cgp::vec3 const& n);
+cgp::vec3 octahedral_decode(cgp::vec2 const& e);
+
+cgp::vec3 unpack_position(packed_skin_mesh const& mesh, packed_skin_vertex const& v);
+cgp::vec3 unpack_normal(packed_skin_vertex const& v);
+cgp::vec2 unpack_uv(packed_skin_vertex const& v);
+cgp::vec4 unpack_weights(packed_skin_vertex const& v);
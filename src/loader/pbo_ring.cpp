@@ -0,0 +1,77 @@
+#include "pbo_ring.hpp"
+#include "resource_manager.hpp"
+
+#include <cstring>
+
+pbo_ring::pbo_ring(size_t slot_bytes_, int slot_count)
+    : slot_bytes(slot_bytes_), buffers(size_t(slot_count > 0 ? slot_count : 1), 0),
+      fences(buffers.size(), nullptr)
+{
+    glGenBuffers(GLsizei(buffers.size()), buffers.data());
+    for (GLuint b : buffers) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, b);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(slot_bytes), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+pbo_ring::~pbo_ring()
+{
+    if (!gl_context_alive()) return;
+    for (GLsync f : fences)
+        if (f) glDeleteSync(f);
+    glDeleteBuffers(GLsizei(buffers.size()), buffers.data());
+}
+
+void pbo_ring::wait(size_t slot)
+{
+    GLsync& fence = fences[slot];
+    if (fence == nullptr) return;
+
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        ++stall_count;
+        do status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);   // 1 ms steps
+        while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void pbo_ring::upload_layer(GLuint texture, int layer, int width, int height,
+                            GLenum format, void const* pixels, size_t bytes)
+{
+    GLint previous_alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+    void* mapped = nullptr;
+    size_t const slot = next;
+    if (bytes <= slot_bytes) {
+        wait(slot);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[slot]);
+        // the fence guarantees the GPU is done with the old contents
+        mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(bytes),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    if (mapped) {
+        std::memcpy(mapped, pixels, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1,
+                        format, GL_UNSIGNED_BYTE, nullptr);          // offset 0 in the PBO
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next = (next + 1) % buffers.size();
+    }
+    else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1,
+                        format, GL_UNSIGNED_BYTE, pixels);
+    }
+    ++upload_count;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+}
@@ -0,0 +1,41 @@
+#pragma once
+// pbo_ring.hpp
+// Ring of pixel unpack buffers for texture uploads that do not block: the
+// pixels are copied into the next buffer and glTexSubImage* returns at once,
+// the driver transfers them while the CPU moves on (to the next decoded
+// frame). A fence per buffer tells when it may be written again.
+// OpenGL thread only.
+
+#include <cstddef>
+#include <vector>
+#include "cgp/cgp.hpp"
+
+struct pbo_ring {
+    /// `slot_count` buffers of `slot_bytes` each
+    explicit pbo_ring(size_t slot_bytes, int slot_count = 4);
+    pbo_ring(pbo_ring const&)            = delete;
+    pbo_ring& operator=(pbo_ring const&) = delete;
+    ~pbo_ring();
+
+    /**
+     * Upload `width` x `height` pixels (GL_UNSIGNED_BYTE, `format` channels,
+     * rows tightly packed) into layer `layer` of the GL_TEXTURE_2D_ARRAY
+     * `texture`. Uploads larger than a slot fall back to a direct copy.
+     */
+    void upload_layer(GLuint texture, int layer, int width, int height,
+                      GLenum format, void const* pixels, size_t bytes);
+
+    size_t uploads() const { return upload_count; }
+    /// Uploads that had to wait for the GPU to release their buffer
+    size_t stalls()  const { return stall_count; }
+
+private:
+    void wait(size_t slot);
+
+    size_t              slot_bytes;
+    std::vector<GLuint> buffers;
+    std::vector<GLsync> fences;
+    size_t              next         = 0;
+    size_t              upload_count = 0;
+    size_t              stall_count  = 0;
+};
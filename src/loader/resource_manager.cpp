@@ -0,0 +1,176 @@
+#include "resource_manager.hpp"
+#include "../utils/process_memory.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+static char const* kind_name(resource_kind kind)
+{
+    switch (kind) {
+    case resource_kind::mesh:          return "mesh";
+    case resource_kind::texture:       return "texture";
+    case resource_kind::texture_array: return "texture_array";
+    case resource_kind::shader:        return "shader";
+    default:                           return "?";
+    }
+}
+
+bool gl_context_alive()
+{
+    return glfwGetCurrentContext() != nullptr;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Resources: the GL objects die with the last reference                     */
+/* -------------------------------------------------------------------------- */
+texture_resource::~texture_resource()
+{
+    if (texture.id != 0 && gl_context_alive())
+        glDeleteTextures(1, &texture.id);
+}
+
+texture_array_resource::~texture_array_resource()
+{
+    if (id != 0 && gl_context_alive())
+        glDeleteTextures(1, &id);
+}
+
+shader_resource::~shader_resource()
+{
+    if (shader.id != 0 && gl_context_alive())
+        glDeleteProgram(shader.id);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  resource_manager                                                          */
+/* -------------------------------------------------------------------------- */
+resource_manager& resources()
+{
+    static resource_manager manager;
+    return manager;
+}
+
+std::string resource_manager::make_key(resource_kind kind, std::string const& path,
+                                       std::string const& options)
+{
+    // "a/../b/./c.png", "./b/c.png" and "/abs/b/c.png" are the same file
+    std::error_code ec;
+    fs::path normalized = fs::weakly_canonical(fs::absolute(path, ec), ec);
+    if (ec)
+        normalized = fs::path(path).lexically_normal();
+
+    std::string key = std::string(kind_name(kind)) + ":" + normalized.generic_string();
+    if (!options.empty())
+        key += "|" + options;
+    return key;
+}
+
+std::shared_ptr<texture_resource> resource_manager::upload_texture(std::string const& key,
+                                                                   decoded_image const& image, GLint wrap)
+{
+    auto t = std::make_shared<texture_resource>();
+    texture_upload_raw(t->texture, image, wrap);
+    t->gpu_bytes = image.size_bytes() * 4 / 3;           // + mip chain
+    return insert(key, t);
+}
+
+std::shared_ptr<texture_resource> resource_manager::texture(std::string const& file,
+                                                            decoded_image const& image, GLint wrap)
+{
+    std::string const key = make_key(resource_kind::texture, file, "wrap=" + std::to_string(wrap));
+    if (auto t = find<texture_resource>(key))
+        return t;
+    return upload_texture(key, image, wrap);
+}
+
+std::shared_ptr<texture_resource> resource_manager::texture(std::string const& file, GLint wrap)
+{
+    std::string const key = make_key(resource_kind::texture, file, "wrap=" + std::to_string(wrap));
+    if (auto t = find<texture_resource>(key))
+        return t;
+    return upload_texture(key, texture_decode_file(file), wrap);
+}
+
+/// Text of `file` with `defines` after its first (#version) line
+static std::string shader_source(std::string const& file, std::string const& defines)
+{
+    std::ifstream in(file);
+    std::string const text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (text.empty())
+        std::cerr << "[resource_manager] cannot read shader " << file << std::endl;
+    size_t const eol = text.find('\n');
+    if (eol == std::string::npos) return text;
+    return text.substr(0, eol + 1) + defines + text.substr(eol + 1);
+}
+
+std::shared_ptr<shader_resource> resource_manager::shader(std::string const& vertex_file,
+                                                          std::string const& fragment_file,
+                                                          std::string const& defines)
+{
+    std::string key = make_key(resource_kind::shader, vertex_file,
+                               "fragment=" + make_key(resource_kind::shader, fragment_file));
+    if (!defines.empty())
+        key += "|defines=" + defines;
+    if (auto s = find<shader_resource>(key))
+        return s;
+
+    auto s = std::make_shared<shader_resource>();
+    if (defines.empty())
+        s->shader.load(vertex_file, fragment_file);
+    else
+        s->shader.load_from_inline_text(shader_source(vertex_file, defines),
+                                        shader_source(fragment_file, defines));
+    return insert(key, s);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Statistics                                                                */
+/* -------------------------------------------------------------------------- */
+resource_stats resource_manager::stats(resource_kind kind)
+{
+    resource_stats s = counters[size_t(kind)];
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        if (it->second.resource.expired()) {
+            it = entries.erase(it);
+            continue;
+        }
+        if (it->second.kind == kind) {
+            ++s.live;
+            s.gpu_bytes += it->second.gpu_bytes;
+        }
+        ++it;
+    }
+    return s;
+}
+
+void resource_manager::print_stats()
+{
+    std::streamsize const precision = std::cout.precision();
+    std::cout << "[resources]      live   GPU MiB   hits  misses\n" << std::fixed << std::setprecision(2);
+    for (size_t k = 0; k < size_t(resource_kind::count); ++k) {
+        resource_stats const s = stats(resource_kind(k));
+        std::cout << "    " << std::left << std::setw(13) << kind_name(resource_kind(k)) << std::right
+                  << std::setw(5)  << s.live
+                  << std::setw(10) << to_mib(s.gpu_bytes)
+                  << std::setw(7)  << s.hits
+                  << std::setw(8)  << s.misses << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision) << std::flush;
+}
+
+void resource_manager::display_gui()
+{
+    for (size_t k = 0; k < size_t(resource_kind::count); ++k) {
+        resource_stats const s = stats(resource_kind(k));
+        ImGui::Text("%-13s %3zu live  %7.2f MiB  %zu hits / %zu misses", kind_name(resource_kind(k)),
+                    s.live, to_mib(s.gpu_bytes), s.hits, s.misses);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+// resource_manager.hpp
+// Single owner of the GPU objects shared between actors: meshes, textures,
+// texture arrays and shaders.
+//   - entries are keyed by normalized path + load options, e.g.
+//     "texture:/abs/assets/shark/textures/SharkBody.png|wrap=10497"
+//   - users hold a std::shared_ptr, the manager only a std::weak_ptr: the
+//     resource destructor deletes the GL objects when the last user goes away
+//   - OpenGL thread only (decode on workers, see asset_pipeline)
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "cgp/cgp.hpp"
+#include "texture_loader.hpp"
+
+enum class resource_kind { mesh, texture, texture_array, shader, count };
+
+/// False once the window (and its GL context) is gone: destructors then skip GL calls
+bool gl_context_alive();
+
+struct texture_resource {
+    static constexpr resource_kind kind = resource_kind::texture;
+    cgp::opengl_texture_image_structure texture;
+    size_t gpu_bytes = 0;                      ///< estimated, mip chain included
+
+    texture_resource() = default;
+    texture_resource(texture_resource const&)            = delete;
+    texture_resource& operator=(texture_resource const&) = delete;
+    ~texture_resource();
+};
+
+struct texture_array_resource {
+    static constexpr resource_kind kind = resource_kind::texture_array;
+    GLuint id = 0;
+    size_t gpu_bytes = 0;
+    int    layers       = 0;
+    int    layers_ready = 0;                   ///< layers [0, layers_ready) are uploaded (streaming)
+
+    texture_array_resource() = default;
+    texture_array_resource(texture_array_resource const&)            = delete;
+    texture_array_resource& operator=(texture_array_resource const&) = delete;
+    ~texture_array_resource();
+};
+
+struct shader_resource {
+    static constexpr resource_kind kind = resource_kind::shader;
+    cgp::opengl_shader_structure shader;
+    size_t gpu_bytes = 0;
+
+    shader_resource() = default;
+    shader_resource(shader_resource const&)            = delete;
+    shader_resource& operator=(shader_resource const&) = delete;
+    ~shader_resource();
+};
+
+struct resource_stats {
+    size_t live      = 0;     ///< entries still referenced
+    size_t gpu_bytes = 0;     ///< estimated resident GPU memory of those
+    size_t hits      = 0;     ///< lookups served from the cache
+    size_t misses    = 0;     ///< lookups that had to load
+};
+
+struct resource_manager {
+    /// "<kind>:<normalized absolute path>|<options>"
+    static std::string make_key(resource_kind kind, std::string const& path,
+                                std::string const& options = "");
+
+    /// Live resource for `key`, or nullptr (counted as a miss)
+    template <typename T> std::shared_ptr<T> find(std::string const& key);
+    /// Register a freshly loaded resource under `key` and hand it back
+    template <typename T> std::shared_ptr<T> insert(std::string const& key, std::shared_ptr<T> resource);
+
+    /* ---- loading helpers: cached, load on a miss ------------------------ */
+    std::shared_ptr<texture_resource> texture(std::string const& file, GLint wrap = GL_REPEAT);
+    /// Same, with the image already decoded (worker thread)
+    std::shared_ptr<texture_resource> texture(std::string const& file, decoded_image const& image,
+                                              GLint wrap = GL_REPEAT);
+    /// `defines`: lines inserted after the #version line of both stages
+    /// (e.g. "#define SKINNING_AFFINE\n"), one program per set of defines
+    std::shared_ptr<shader_resource>  shader(std::string const& vertex_file,
+                                             std::string const& fragment_file,
+                                             std::string const& defines = "");
+
+    /// Per-kind statistics (drops the entries nobody references anymore)
+    resource_stats stats(resource_kind kind);
+    void print_stats();
+    void display_gui();
+
+private:
+    std::shared_ptr<texture_resource> upload_texture(std::string const& key,
+                                                     decoded_image const& image, GLint wrap);
+
+    struct entry {
+        resource_kind         kind;
+        std::weak_ptr<void>   resource;
+        size_t                gpu_bytes;
+    };
+    std::unordered_map<std::string, entry> entries;
+    resource_stats counters[size_t(resource_kind::count)];
+};
+
+/// The process-wide manager
+resource_manager& resources();
+
+
+template <typename T>
+std::shared_ptr<T> resource_manager::find(std::string const& key)
+{
+    resource_stats& c = counters[size_t(T::kind)];
+    auto it = entries.find(key);
+    if (it != entries.end() && it->second.kind == T::kind) {
+        if (std::shared_ptr<void> p = it->second.resource.lock()) {
+            ++c.hits;
+            return std::static_pointer_cast<T>(p);
+        }
+    }
+    ++c.misses;
+    return nullptr;
+}
+
+template <typename T>
+std::shared_ptr<T> resource_manager::insert(std::string const& key, std::shared_ptr<T> resource)
+{
+    entries[key] = entry{ T::kind, resource, resource->gpu_bytes };
+    return resource;
+}
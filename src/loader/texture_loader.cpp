@@ -0,0 +1,63 @@
+#include <stb_image.h>
+#include "texture_loader.hpp"
+
+#include <stdexcept>
+
+decoded_image texture_decode_file(std::string const& filename)
+{
+    decoded_image im;
+    stbi_uc* pixels = stbi_load(filename.c_str(), &im.width, &im.height, &im.components, 0);
+    if (pixels == nullptr)
+        throw std::runtime_error("Cannot decode image " + filename + ": " + stbi_failure_reason());
+
+    im.pixels.reset(pixels, stbi_image_free);
+    return im;
+}
+
+void texture_upload_raw(cgp::opengl_texture_image_structure& tex,
+                        void const* pixels, int width, int height,
+                        int components, int bits,
+                        GLint wrap, bool mipmap)
+{
+    static GLint  const internal_8 [4] = { GL_R8,  GL_RG8,  GL_RGB8,  GL_RGBA8  };
+    static GLint  const internal_16[4] = { GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 };
+    static GLenum const format     [4] = { GL_RED, GL_RG,   GL_RGB,   GL_RGBA   };
+
+    if (components < 1 || components > 4 || (bits != 8 && bits != 16))
+        throw std::runtime_error("texture_upload_raw: unsupported image (" + std::to_string(components)
+                                 + " channels, " + std::to_string(bits) + " bits)");
+
+    GLint const  internal = (bits == 8 ? internal_8 : internal_16)[components - 1];
+    GLenum const type     = bits == 8 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+    size_t const row      = size_t(width) * size_t(components) * size_t(bits / 8);
+
+    if (tex.id == 0)
+        glGenTextures(1, &tex.id);
+    glBindTexture(GL_TEXTURE_2D, tex.id);
+
+    // RGB8 rows of odd width are not 4-byte aligned
+    GLint previous_alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, row % 4 == 0 ? 4 : 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0,
+                 format[components - 1], type, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+
+    if (components <= 2) {   // grey (+ alpha) rather than red (+ green)
+        GLint const swizzle[4] = { GL_RED, GL_RED, GL_RED, components == 2 ? GL_GREEN : GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    if (mipmap)
+        glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    tex.width        = width;
+    tex.height       = height;
+    tex.format       = internal;
+    tex.texture_type = GL_TEXTURE_2D;
+}
@@ -0,0 +1,44 @@
+#pragma once
+// texture_loader.hpp
+// Image decoding split from the OpenGL upload, so that decoding can run on
+// a worker thread (see asset_pipeline). Pixels are uploaded as decoded:
+// no float conversion, no forced channel count.
+
+#include <memory>
+#include <string>
+#include "cgp/cgp.hpp"
+
+/// Image as decoded by stb_image: rows tightly packed, 1 to 4 channels of 8 bits
+struct decoded_image {
+    int width      = 0;
+    int height     = 0;
+    int components = 0;
+    std::shared_ptr<unsigned char> pixels;   ///< freed with stbi_image_free
+
+    size_t size_bytes() const { return size_t(width) * size_t(height) * size_t(components); }
+};
+
+/// Decode a PNG / JPG file, keeping its channel count. No OpenGL call (any thread).
+/// @throw std::runtime_error if the file cannot be read or decoded.
+decoded_image texture_decode_file(std::string const& filename);
+
+/**
+ * Upload tightly packed pixels straight to a GL_TEXTURE_2D (GL thread).
+ * The internal format follows the data (R8, RG8, RGB8, RGBA8 or their 16-bit
+ * versions), the unpack alignment follows the row size, and 1/2-channel
+ * images are swizzled to grey / grey+alpha. Creates tex.id if it is 0.
+ *
+ * @throw std::runtime_error on an unsupported channel count or bit depth.
+ */
+void texture_upload_raw(cgp::opengl_texture_image_structure& tex,
+                        void const* pixels, int width, int height,
+                        int components, int bits = 8,
+                        GLint wrap = GL_REPEAT, bool mipmap = true);
+
+inline void texture_upload_raw(cgp::opengl_texture_image_structure& tex,
+                               decoded_image const& image,
+                               GLint wrap = GL_REPEAT, bool mipmap = true)
+{
+    texture_upload_raw(tex, image.pixels.get(), image.width, image.height,
+                       image.components, 8, wrap, mipmap);
+}
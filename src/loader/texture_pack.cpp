@@ -0,0 +1,357 @@
+#include <stb_image.h>
+#include "texture_pack.hpp"
+#include "../utils/timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+static constexpr char     pack_magic[8]  = { 'S','E','A','T','E','X','\0','\0' };
+static constexpr uint64_t pack_alignment = 16;
+
+static uint64_t align_up(uint64_t x) { return (x + pack_alignment - 1) & ~(pack_alignment - 1); }
+
+static uint64_t level_bytes(texture_pack_format format, int w, int h)
+{
+    if (format == texture_pack_format::bc4)
+        return uint64_t((w + 3) / 4) * uint64_t((h + 3) / 4) * 8;
+    return uint64_t(w) * uint64_t(h);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  BC4                                                                       */
+/* -------------------------------------------------------------------------- */
+/// The 8 values of a block with red0 > red1 (or all equal to red0)
+static void bc4_palette(int r0, int r1, int palette[8])
+{
+    palette[0] = r0;
+    palette[1] = r1;
+    if (r0 > r1) {
+        for (int k = 1; k <= 6; ++k)
+            palette[k + 1] = ((7 - k) * r0 + k * r1 + 3) / 7;
+    }
+    else {
+        for (int k = 1; k <= 4; ++k)
+            palette[k + 1] = ((5 - k) * r0 + k * r1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+std::vector<unsigned char> bc4_encode(unsigned char const* pixels, int w, int h)
+{
+    int const bw = (w + 3) / 4, bh = (h + 3) / 4;
+    std::vector<unsigned char> out(size_t(bw) * size_t(bh) * 8);
+    unsigned char* block = out.data();
+
+    for (int by = 0; by < bh; ++by)
+    for (int bx = 0; bx < bw; ++bx, block += 8)
+    {
+        int texel[16];
+        int lo = 255, hi = 0;
+        for (int k = 0; k < 16; ++k) {
+            int const x = std::min(4 * bx + (k & 3), w - 1);
+            int const y = std::min(4 * by + (k >> 2), h - 1);
+            texel[k] = pixels[size_t(y) * size_t(w) + size_t(x)];
+            lo = std::min(lo, texel[k]);
+            hi = std::max(hi, texel[k]);
+        }
+
+        int palette[8];
+        bc4_palette(hi, lo, palette);
+        uint64_t indices = 0;
+        for (int k = 0; k < 16; ++k) {
+            int best = 0;
+            for (int c = 1; c < 8; ++c)
+                if (std::abs(palette[c] - texel[k]) < std::abs(palette[best] - texel[k])) best = c;
+            indices |= uint64_t(best) << (3 * k);
+        }
+
+        block[0] = (unsigned char)hi;
+        block[1] = (unsigned char)lo;
+        for (int b = 0; b < 6; ++b)
+            block[2 + b] = (unsigned char)(indices >> (8 * b));
+    }
+    return out;
+}
+
+std::vector<unsigned char> bc4_decode(unsigned char const* blocks, int w, int h)
+{
+    int const bw = (w + 3) / 4, bh = (h + 3) / 4;
+    std::vector<unsigned char> out(size_t(w) * size_t(h));
+    for (int by = 0; by < bh; ++by)
+    for (int bx = 0; bx < bw; ++bx)
+    {
+        unsigned char const* block = blocks + (size_t(by) * size_t(bw) + size_t(bx)) * 8;
+        int palette[8];
+        bc4_palette(block[0], block[1], palette);
+        uint64_t indices = 0;
+        for (int b = 0; b < 6; ++b)
+            indices |= uint64_t(block[2 + b]) << (8 * b);
+        for (int k = 0; k < 16; ++k) {
+            int const x = 4 * bx + (k & 3), y = 4 * by + (k >> 2);
+            if (x < w && y < h)
+                out[size_t(y) * size_t(w) + size_t(x)] = (unsigned char)palette[(indices >> (3 * k)) & 7];
+        }
+    }
+    return out;
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  texture_pack                                                              */
+/* -------------------------------------------------------------------------- */
+bool texture_pack::open(std::string const& path)
+{
+    header = nullptr;
+    level_table = nullptr;
+    if (!file.open(path)) return false;
+
+    auto fail = [this]() { file.close(); header = nullptr; level_table = nullptr; return false; };
+    if (file.size() < sizeof(texture_pack_header)) return fail();
+    header = reinterpret_cast<texture_pack_header const*>(file.data());
+    if (std::memcmp(header->magic, pack_magic, sizeof(pack_magic)) != 0) return fail();
+    if (header->version != texture_pack_version) return fail();
+    if (header->format > uint32_t(texture_pack_format::bc4)) return fail();
+    if (header->levels == 0 || header->levels > 32 || header->layers == 0) return fail();
+
+    uint64_t const table_end = sizeof(texture_pack_header) + uint64_t(header->levels) * sizeof(texture_pack_level);
+    if (table_end > file.size()) return fail();
+    level_table = reinterpret_cast<texture_pack_level const*>(file.data() + sizeof(texture_pack_header));
+
+    for (uint32_t l = 0; l < header->levels; ++l) {
+        texture_pack_level const& lv = level_table[l];
+        if (lv.bytes != level_bytes(format(), int(lv.width), int(lv.height))) return fail();
+        if (lv.offset + lv.bytes > header->layer_stride) return fail();
+    }
+    if (header->first_layer > file.size()) return fail();
+    if (header->layer_stride == 0
+        || uint64_t(header->layers) > (file.size() - header->first_layer) / header->layer_stride) return fail();
+    return true;
+}
+
+GLuint texture_pack::allocate_array(int count) const
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    for (int l = 0; l < levels(); ++l) {
+        texture_pack_level const& lv = level(l);
+        if (format() == texture_pack_format::bc4)
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, l, GL_COMPRESSED_RED_RGTC1,
+                                   GLsizei(lv.width), GLsizei(lv.height), count, 0,
+                                   GLsizei(lv.bytes * uint64_t(count)), nullptr);
+        else
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, l, GL_R8, GLsizei(lv.width), GLsizei(lv.height), count, 0,
+                         GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL,  levels() - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S,     GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T,     GL_REPEAT);
+    return tex;
+}
+
+void texture_pack::upload_layer(GLuint array, int array_layer, int layer) const
+{
+    GLint previous_alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);              // odd widths in the mip chain
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+    for (int l = 0; l < levels(); ++l) {
+        texture_pack_level const& lv = level(l);
+        if (format() == texture_pack_format::bc4)
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, array_layer,
+                                      GLsizei(lv.width), GLsizei(lv.height), 1,
+                                      GL_COMPRESSED_RED_RGTC1, GLsizei(lv.bytes), data(layer, l));
+        else
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, array_layer,
+                            GLsizei(lv.width), GLsizei(lv.height), 1,
+                            GL_RED, GL_UNSIGNED_BYTE, data(layer, l));
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*  Files                                                                     */
+/* -------------------------------------------------------------------------- */
+std::string texture_pack_path(std::string const& base)
+{
+    return base + ".texpack";
+}
+
+std::shared_ptr<texture_pack> texture_pack_open_fresh(std::string const& base,
+                                                      std::vector<std::string> const& frames)
+{
+    std::string const path = texture_pack_path(base);
+    std::error_code ec;
+    auto const pack_time = fs::last_write_time(path, ec);
+    if (ec) return nullptr;
+    for (std::string const& frame : frames) {
+        auto const t = fs::last_write_time(frame, ec);
+        if (ec || t > pack_time) return nullptr;
+    }
+
+    auto pack = std::make_shared<texture_pack>();
+    if (!pack->open(path) || pack->layers() != int(frames.size()))
+        return nullptr;
+    return pack;
+}
+
+/// Next level of a wrapping R8 image: 2x2 box filter
+static std::vector<unsigned char> downsample(std::vector<unsigned char> const& src, int w, int h,
+                                             int& w2, int& h2)
+{
+    w2 = std::max(1, w / 2);
+    h2 = std::max(1, h / 2);
+    std::vector<unsigned char> dst(size_t(w2) * size_t(h2));
+    for (int y = 0; y < h2; ++y)
+    for (int x = 0; x < w2; ++x) {
+        int const x0 = (2 * x) % w, x1 = (2 * x + 1) % w;
+        int const y0 = (2 * y) % h, y1 = (2 * y + 1) % h;
+        int const sum = src[size_t(y0) * w + x0] + src[size_t(y0) * w + x1]
+                      + src[size_t(y1) * w + x0] + src[size_t(y1) * w + x1];
+        dst[size_t(y) * w2 + x] = (unsigned char)((sum + 2) / 4);
+    }
+    return dst;
+}
+
+void texture_pack_bake(std::string const& base, std::vector<std::string> const& frames,
+                       texture_pack_format format)
+{
+    if (frames.empty()) return;
+
+    // --- 1) decode every frame: the cost the pack removes at startup ---
+    auto t0 = std::chrono::steady_clock::now();
+    int W = 0, H = 0;
+    std::vector<std::vector<unsigned char>> images;
+    for (std::string const& frame : frames) {
+        int w, h, c;
+        stbi_uc* pixels = stbi_load(frame.c_str(), &w, &h, &c, 1);
+        if (!pixels)
+            throw std::runtime_error("Cannot decode " + frame);
+        if (images.empty()) { W = w; H = h; }
+        if (w != W || h != H) {
+            stbi_image_free(pixels);
+            throw std::runtime_error(frame + " does not have the size of the first frame");
+        }
+        images.emplace_back(pixels, pixels + size_t(w) * size_t(h));
+        stbi_image_free(pixels);
+    }
+    double const decode_ms = elapsed_ms(t0);
+
+    // --- 2) level table ---
+    texture_pack_header header{};
+    std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+    header.version = texture_pack_version;
+    header.format  = uint32_t(format);
+    header.width   = uint32_t(W);
+    header.height  = uint32_t(H);
+    header.layers  = uint32_t(frames.size());
+
+    std::vector<texture_pack_level> levels;
+    uint64_t offset = 0;
+    for (int w = W, h = H; ; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        texture_pack_level lv{ uint32_t(w), uint32_t(h), offset, level_bytes(format, w, h) };
+        levels.push_back(lv);
+        offset = align_up(offset + lv.bytes);
+        if (w == 1 && h == 1) break;
+    }
+    header.levels       = uint32_t(levels.size());
+    header.first_layer  = align_up(sizeof(header) + levels.size() * sizeof(texture_pack_level));
+    header.layer_stride = offset;
+
+    // --- 3) mip chains (+ compression), written next to the target then renamed ---
+    std::string const path = texture_pack_path(base);
+    std::string const tmp  = path + ".tmp";
+    double error_sum = 0;
+    int    error_max = 0;
+    size_t error_texels = 0;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("Cannot write texture pack " + tmp);
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const*>(levels.data()),
+                  std::streamsize(levels.size() * sizeof(texture_pack_level)));
+
+        char const zeros[pack_alignment] = {};
+        std::vector<unsigned char> layer(size_t(header.layer_stride));
+        for (std::vector<unsigned char>& image : images) {
+            std::fill(layer.begin(), layer.end(), (unsigned char)0);
+            std::vector<unsigned char> level = std::move(image);
+            int w = W, h = H;
+            for (texture_pack_level const& lv : levels) {
+                if (format == texture_pack_format::bc4) {
+                    std::vector<unsigned char> const blocks = bc4_encode(level.data(), w, h);
+                    std::vector<unsigned char> const back   = bc4_decode(blocks.data(), w, h);
+                    for (size_t k = 0; k < level.size(); ++k) {
+                        int const e = std::abs(int(back[k]) - int(level[k]));
+                        error_sum += e;
+                        error_max  = std::max(error_max, e);
+                    }
+                    error_texels += level.size();
+                    std::memcpy(layer.data() + lv.offset, blocks.data(), blocks.size());
+                }
+                else {
+                    std::memcpy(layer.data() + lv.offset, level.data(), level.size());
+                }
+                if (w > 1 || h > 1) {
+                    int w2, h2;
+                    level = downsample(level, w, h, w2, h2);
+                    w = w2;
+                    h = h2;
+                }
+            }
+
+            uint64_t const pos = uint64_t(out.tellp());
+            if (pos < header.first_layer)
+                out.write(zeros, std::streamsize(header.first_layer - pos));
+            out.write(reinterpret_cast<char const*>(layer.data()), std::streamsize(layer.size()));
+        }
+        if (!out)
+            throw std::runtime_error("Error while writing texture pack " + tmp);
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec)
+        throw std::runtime_error("Cannot move " + tmp + " to " + path + ": " + ec.message());
+
+    // --- 4) read back: mapping + touching every byte is all the loading left ---
+    t0 = std::chrono::steady_clock::now();
+    texture_pack pack;
+    if (!pack.open(path))
+        throw std::runtime_error("Freshly baked texture pack cannot be read back: " + path);
+    uint64_t checksum = 0;
+    for (int i = 0; i < pack.layers(); ++i) {
+        unsigned char const* p = pack.data(i, 0);
+        for (size_t k = 0; k < pack.layer_bytes(); k += 64) checksum += p[k];
+    }
+    double const pack_ms = elapsed_ms(t0);
+    volatile uint64_t sink = checksum;                  // keep the reads
+    (void)sink;
+
+    std::cout << "[texture_pack] " << path << "\n"
+              << "    " << frames.size() << " frames " << W << "x" << H << ", "
+              << levels.size() << " levels, "
+              << (format == texture_pack_format::bc4 ? "BC4" : "R8") << ", "
+              << pack.file_bytes() / 1024 << " KiB (R8 without mips: "
+              << size_t(W) * size_t(H) * frames.size() / 1024 << " KiB)\n";
+    if (format == texture_pack_format::bc4)
+        std::cout << "    BC4 error  : mean " << error_sum / double(std::max<size_t>(error_texels, 1))
+                  << ", max " << error_max << " (of 255, every level)\n";
+    std::cout << "    JPEG decode: " << decode_ms << " ms\n"
+              << "    pack load  : " << pack_ms << " ms\n";
+}
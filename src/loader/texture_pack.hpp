@@ -0,0 +1,100 @@
+#pragma once
+// texture_pack.hpp
+// Baked frame sequence ("<base>.texpack"): every frame of an image sequence
+// with its full mip chain, stored the way GL wants it, so that loading is one
+// mapping and one glTexSubImage3D / glCompressedTexSubImage3D per level -
+// no JPEG decoding, no glGenerateMipmap.
+//
+// Layout (little endian, 16-byte aligned like mesh_cache):
+//
+//   texture_pack_header
+//   texture_pack_level[levels]
+//   layer 0: level 0, level 1, ... level n-1 (each 16-byte aligned)
+//   layer 1: ...                              (layer_stride bytes apart)
+//
+// Each layer is contiguous, so a streamed frame is one range of the file.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cgp/cgp.hpp"
+#include "mapped_file.hpp"
+
+constexpr uint32_t texture_pack_version = 1;
+
+enum class texture_pack_format : uint32_t {
+    r8  = 0,    ///< GL_R8, 1 byte per texel
+    bc4 = 1     ///< GL_COMPRESSED_RED_RGTC1, 8 bytes per 4x4 block
+};
+
+struct texture_pack_header {
+    char     magic[8];          ///< "SEATEX\0\0"
+    uint32_t version;           ///< texture_pack_version
+    uint32_t format;            ///< texture_pack_format
+    uint32_t width, height;     ///< level 0
+    uint32_t layers, levels;
+    uint64_t first_layer;       ///< offset of layer 0 from the start of the file
+    uint64_t layer_stride;      ///< bytes from one layer to the next
+};
+
+struct texture_pack_level {
+    uint32_t width, height;
+    uint64_t offset;            ///< inside the layer
+    uint64_t bytes;
+};
+
+/// Read-only view over a mapped pack
+struct texture_pack {
+    /// Map `path` and check it. Returns false (and stays closed) on failure.
+    bool open(std::string const& path);
+
+    texture_pack_format format() const { return texture_pack_format(header->format); }
+    int    width()  const { return int(header->width); }
+    int    height() const { return int(header->height); }
+    int    layers() const { return int(header->layers); }
+    int    levels() const { return int(header->levels); }
+    size_t layer_bytes() const { return size_t(header->layer_stride); }
+    size_t file_bytes()  const { return file.size(); }
+    texture_pack_level const& level(int l) const { return level_table[l]; }
+    unsigned char const* data(int layer, int l) const
+    {
+        return file.data() + header->first_layer + uint64_t(layer) * header->layer_stride
+             + level_table[l].offset;
+    }
+
+    /// Allocate a W x H x `count` array with the pack's format and mip chain
+    /// (left bound to GL_TEXTURE_2D_ARRAY). OpenGL thread.
+    GLuint allocate_array(int count) const;
+    /// Upload every level of pack layer `layer` into `array_layer` of `array`.
+    /// OpenGL thread.
+    void upload_layer(GLuint array, int array_layer, int layer) const;
+
+private:
+    mapped_file                file;
+    texture_pack_header const* header      = nullptr;
+    texture_pack_level  const* level_table = nullptr;
+};
+
+/// "<base>.texpack"
+std::string texture_pack_path(std::string const& base);
+
+/// The pack of the sequence `frames` if it exists, is valid and is newer
+/// than every frame; nullptr otherwise.
+std::shared_ptr<texture_pack> texture_pack_open_fresh(std::string const& base,
+                                                      std::vector<std::string> const& frames);
+
+/// Decode `frames` (one channel kept), build the mip chains (2x2 box filter,
+/// wrapping: the frames tile) and write "<base>.texpack": raw R8 unless
+/// `format` asks for the lossy bc4. Prints the JPEG and pack load times and,
+/// for bc4, the compression error. No OpenGL needed.
+/// @throw std::runtime_error if a frame is missing or the file cannot be written.
+void texture_pack_bake(std::string const& base, std::vector<std::string> const& frames,
+                       texture_pack_format format = texture_pack_format::r8);
+
+/* ---- block compression (CPU side, any thread) ----------------------------- */
+/// BC4 (RGTC1 unsigned) of a w x h R8 image, blocks in row order; edge
+/// blocks replicate the last row / column
+std::vector<unsigned char> bc4_encode(unsigned char const* pixels, int w, int h);
+/// Inverse of bc4_encode, for error measurements
+std::vector<unsigned char> bc4_decode(unsigned char const* blocks, int w, int h);
@@ -32,10 +32,22 @@ void display_gui_default();
 
 timer_fps fps_record;
 
-int main(int, char* argv[])
+int main(int argc, char* argv[])
 {
 	std::cout << "Run " << argv[0] << std::endl;
 
+	// Offline mode: write the binary asset caches and exit (no window needed);
+	// --bc4 block-compresses the texture packs (lossy, 1/2 of R8)
+	if (argc > 1 && std::string(argv[1]) == "--bake-assets") {
+		project::path = cgp::project_path_find(argv[0], "shaders/");
+		scene_structure::bake_assets(argc > 2 && std::string(argv[2]) == "--bc4");
+		return 0;
+	}
+	// Headless micro-benchmarks: --bench <name>
+	if (argc > 2 && std::string(argv[1]) == "--bench") {
+		project::path = cgp::project_path_find(argv[0], "shaders/");
+		return scene_structure::run_benchmark(argv[2]) ? 0 : 1;
+	}
 	
 
 	// ************************ //
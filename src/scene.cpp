@@ -1,11 +1,26 @@
 #include "scene.hpp"
 #include "loader/animated_texture.hpp"
+#include "loader/texture_loader.hpp"
+#include "loader/mesh_cache.hpp"
+#include "loader/texture_pack.hpp"
+#include "benchmark/benchmarks.hpp"
+#include "utils/process_memory.hpp"
+#include "utils/timing.hpp"
 #include "actors/shark_actor.hpp"
 
 #include <GLFW/glfw3.h> 
 
 using namespace cgp;
 
+// glTF assets of the scene (relative to project::path)
+static const std::string turtle_gltf = "assets/sea_turtle/sea_turtle.gltf";
+static const std::string shark_gltf  = "assets/shark/scene.gltf";
+static const std::string turtle_texture = "assets/sea_turtle/textures/Tortue_PBRMaterial_baseColor.png";
+static const std::string shark_texture  = "assets/shark/textures/SharkBody.png";
+// caustic flipbook: caustic_base + "%04d.jpg", also baked to caustic_base + ".texpack"
+static const std::string caustic_base = "assets/caustics/02B_Caribbean_Caustics_Deep_FREE_SAMPLE_";
+static constexpr int     caustic_frames = 240;
+
 bool equals_exact(cgp::vec3 const& a, cgp::vec3 const& b) {
     return a.x == b.x
         && a.y == b.y
@@ -51,13 +66,66 @@ void scene_structure::initialize()
     // ********************************************** //
 
     
-    turtle_shader.load(
+    turtle_shader_res = resources().shader(
         project::path + "shaders/turtle/turtle.vert.glsl",
         project::path + "shaders/mesh/custom_mesh.frag.glsl");
+    turtle_shader = turtle_shader_res->shader;
+    for (skinning_mode mode : { skinning_mode::matrix, skinning_mode::affine, skinning_mode::dual_quaternion })
+        skinning_shaders[int(mode)] = resources().shader(
+            project::path + "shaders/turtle/turtle.vert.glsl",
+            project::path + "shaders/mesh/custom_mesh.frag.glsl",
+            skinning_defines(mode));
+    bones = std::make_unique<bone_palette>();
+    set_update_threads(int(std::max(1u, std::thread::hardware_concurrency())));
+
+    // Assets are decoded in the background; initialize_actors() runs once they are on the GPU
+    start_loading();
+}
+
+
+void scene_structure::start_loading()
+{
+    loading = std::make_unique<asset_pipeline>();
+
+    opengl_shader_structure const& shader = turtle_shader;
+    auto add_actor = [&](std::string const& name, std::string const& gltf, std::string const& texture)
+    {
+        loading->add(name,
+            [gltf]() { return skinned_actor::decode_gltf(gltf); },
+            [this, gltf, &shader](gltf_geometry_and_texture& data) {
+                preloaded.push_back(skinned_actor::preload_gltf(gltf, std::move(data), shader));
+            });
+        loading->add(name,
+            [texture]() { return texture_decode_file(texture); },
+            [this, texture](decoded_image& image) {
+                preloaded.push_back(resources().texture(texture, image, GL_REPEAT));
+            });
+    };
+    add_actor("turtle", project::path + turtle_gltf, project::path + turtle_texture);
+    add_actor("shark",  project::path + shark_gltf,  project::path + shark_texture);
+
+    caustics = create_flipbook_stream_async(
+        *loading,
+        project::path + caustic_base,
+        caustic_frames,
+        caustic_budget_bytes,
+        caustic_decimation,
+        4,
+        image_format::jpg
+    );
+    if (caustics)
+        caustics->set_blend(true);  // the decimated frames are cross-faded
+    environment.caustic_array_tex = caustics ? caustics->texture() : 0;
+}
+
+
+void scene_structure::initialize_actors()
+{
+    auto t0 = std::chrono::steady_clock::now();
 
     turtle.initialize(turtle_shader,
-            project::path + "assets/sea_turtle/sea_turtle.gltf",
-            project::path + "assets/sea_turtle/textures/Tortue_PBRMaterial_baseColor.png");
+            project::path + turtle_gltf,
+            project::path + turtle_texture);
 
     
     turtle.start_position();
@@ -71,30 +139,52 @@ void scene_structure::initialize()
         { 0.0f, 0.0f, 1.0f }   // 'up' is still Z
     );
 
-    environment.caustic_array_tex = create_texture_array_from_sequence(
-        project::path + "assets/caustics/02B_Caribbean_Caustics_Deep_FREE_SAMPLE_",
-        240,
-        4,
-        image_format::jpg
-    );
-
     spawn_shark();
-    
+    apply_skinning();
+
+    timer.update();   // the loading time is not a frame step
+    std::cout << "[scene] actors ready in " << elapsed_ms(t0) << " ms" << std::endl;
 }
 
 
 void scene_structure::spawn_shark()
 {
     if (sharks.size() == 0){
-        shark_actor s;
-        s.initialize(turtle_shader,
-            project::path + "assets/shark/scene.gltf",
-            project::path + "assets/shark/textures/SharkBody.png");
-        sharks.push_back(std::move(s));
+        sharks.emplace_back().initialize(turtle_shader,   // in place: no actor copy or move
+            project::path + shark_gltf,
+            project::path + shark_texture);
+        npc_shark = npcs.add_species(sharks[0]);         // sharks never grows again
     }
     sharks[0].start_position(turtle);
 }
 
+void scene_structure::roaming_path(cgp::vec3& origin, cgp::vec3& goal, float& speed)
+{
+    std::uniform_real_distribution<float> angle(0.0f, 2 * cgp::Pi), radius(15.0f, 30.0f),
+                                          height(-0.5f, 3.0f), drift(-0.4f, 0.4f), swim(1.5f, 4.0f);
+    cgp::vec3 const c = turtle.drawable.model.translation;
+    float const a = angle(npc_random), r = radius(npc_random);
+    float const b = a + cgp::Pi + drift(npc_random);   // to the far side, not straight at the turtle
+    origin = c + cgp::vec3{ r * std::cos(a), r * std::sin(a), height(npc_random) };
+    goal   = c + cgp::vec3{ r * std::cos(b), r * std::sin(b), height(npc_random) };
+    speed  = swim(npc_random);
+}
+
+void scene_structure::set_npc_count(int count)
+{
+    npc_count = std::max(count, 0);
+    npcs.reserve(size_t(npc_count));
+    std::uniform_real_distribution<float> cycle(0.0f, 1.0f);
+    while (npcs.size() < size_t(npc_count)) {
+        cgp::vec3 origin, goal;
+        float speed;
+        roaming_path(origin, goal, speed);
+        npcs.spawn(npc_shark, origin, goal, speed, cycle(npc_random));
+    }
+    for (size_t h = npcs.capacity(); h-- > 0 && npcs.size() > size_t(npc_count);)
+        npcs.kill(npc_manager::handle(h));
+}
+
 //------------------------------------------------------------------------------
 // Move the turtle and immediately re-anchor the camera
 
@@ -104,6 +194,27 @@ void scene_structure::display_frame()
     // Set the light to the current position of the camera
 	environment.light = camera_control.camera_model.position();
 
+	// Startup: upload what the workers decoded, start the game once the actors
+	// are there; the caustic frames keep streaming in meanwhile
+	if (loading) {
+		loading->pump(actors_ready ? 2.0 : 8.0);
+		if (!actors_ready) {
+			if (!loading->done("turtle") || !loading->done("shark"))
+				return;
+			initialize_actors();
+			preloaded.clear();          // the actors hold their resources now
+			actors_ready = true;
+		}
+		if (loading->done()) {
+			loading->print_report();
+			std::cout << "[scene] peak RSS after loading: " << to_mib(process_peak_rss_bytes()) << " MiB" << std::endl;
+			loading.reset();
+			resources().print_stats();
+		}
+	}
+
+	frame_triangles = 0;
+	frame_skinned_draws = 0;
 	if (!game_over) {
 		float t_prev = timer.t;
 
@@ -111,20 +222,26 @@ void scene_structure::display_frame()
 		timer.update();
 		float dt = timer.t - t_prev;
 		environment.uniform_generic.uniform_float["time"] = timer.t;
+		if (caustics) {               // the ring may be reallocated (budget)
+			caustics->update(timer.t, environment.caustic_fps);
+			environment.caustic_layer      = caustics->layer();
+			environment.caustic_next_layer = caustics->next_layer();
+			environment.caustic_blend      = caustics->blend_weight();
+			environment.caustic_array_tex  = caustics->texture();
+		}
 
-		
-		/* ------------ Turtle -------------------------------------- */
-
-		turtle.animate(timer.t);
-		draw(turtle.drawable, environment);          
-			
+		update_phase(dt);
 
-		/* ======== SHARK ======================================================= */
+		/* ------------ render phase: palette upload, then draws ---------- */
         // only one shark in the vector:
         shark_actor& sh = sharks[0];
-        sh.update_position(dt);
-        sh.animate(timer.t);
-        draw(sh.drawable, environment);
+        publish_poses();
+        draw_actor(turtle);
+        draw_actor(sh);
+        frame_triangles += school.draw(environment);
+        frame_skinned_draws += school.draw_calls();
+        frame_triangles += npcs.draw(environment);
+        frame_skinned_draws += npcs.draw_calls();
 
         // only retire & respawn if *not* eaten:
         if (!sh.check_for_collision(turtle)) {
@@ -139,13 +256,14 @@ void scene_structure::display_frame()
         handle_keyboard_movement();
 	}
 	else {
-		draw(turtle.drawable, environment);
+		publish_poses();
+		draw_actor(turtle);
 		ImGui::Begin("Game"); 
 		ImGui::Text("💥 Turtle got eaten!");
 		if (ImGui::Button("Restart")) {
 			game_over = false;
 			timer.update();
-            initialize();      // reset everything
+            initialize_actors();      // reset everything
 		}
 		ImGui::End();
 	}
@@ -156,15 +274,198 @@ void scene_structure::display_frame()
 	if (gui.display_frame)
 		draw(global_frame, environment);
 	if (gui.display_wireframe) {
-		draw_wireframe(shark.drawable, environment);
-		draw_wireframe(turtle.drawable, environment);
+		for (shark_actor const& sh : sharks) {
+			sh.draw(environment, /*wireframe=*/true);
+			frame_skinned_draws += sh.draw_calls();
+		}
+		turtle.draw(environment, /*wireframe=*/true);
+		frame_skinned_draws += turtle.draw_calls();
+		school.draw(environment, /*wireframe=*/true);
+		frame_skinned_draws += school.draw_calls();
+		npcs.draw(environment, /*wireframe=*/true);
+		frame_skinned_draws += npcs.draw_calls();
+	}
+}
+
+void scene_structure::set_update_threads(int count)
+{
+	update_threads = std::max(count, 1);
+	workers.reset();   // joins the previous workers
+	if (update_threads > 1)
+		workers = std::make_unique<thread_pool>(unsigned(update_threads - 1));
+}
+
+void scene_structure::update_phase(float dt)
+{
+	auto const t0 = std::chrono::steady_clock::now();
+	for (shark_actor& sh : sharks)
+		sh.update_position(dt);
+	npcs.update(dt, workers.get());
+	for (npc_manager::handle h : npcs.expired()) {   // recycled in place: no allocation
+		cgp::vec3 origin, goal;
+		float speed;
+		roaming_path(origin, goal, speed);
+		npcs.respawn(h, origin, goal, speed);
+	}
+	collide_npcs();
+
+	// actors only write their own pose and uBones: one job per range of them
+	anim_lod.frozen_beyond = environment.fog_d_max;
+	anim_lod.begin_frame(environment.camera_view, environment.camera_projection, dt);
+	update_actors.clear();
+	update_actors.push_back(&turtle);
+	for (shark_actor& sh : sharks)
+		update_actors.push_back(&sh);
+	float const t = timer.t;
+	auto animate = [this, t](size_t first, size_t last) {
+		for (size_t k = first; k < last; ++k) {
+			if (update_actors[k] == &turtle) turtle.animate(t);   // the player: always full rate
+			else                             anim_lod.animate(*update_actors[k], k, t);
+		}
+	};
+	if (workers)
+		workers->parallel_for(update_actors.size(), animate);
+	else
+		animate(0, update_actors.size());
+	school.animate(t, workers.get(), &anim_lod);
+	frame_update_ms = elapsed_ms(t0);
+}
+
+void scene_structure::collide_npcs()
+{
+	npc_contacts = 0;
+	npc_grid.build(npcs.position.data(), npcs.radius.data(), npcs.capacity());
+	npc_grid.find_pairs(npc_pairs, workers.get());
+	if (npc_avoidance) {
+		constexpr float rate = 0.2f;   // part of the overlap resolved per frame: no jitter
+		for (broadphase_pair const& p : npc_pairs) {
+			cgp::vec3 const d = npcs.position[p.b] - npcs.position[p.a];
+			float const l = norm(d);
+			float const push = 0.5f * rate * (npcs.radius[p.a] + npcs.radius[p.b] - l);
+			if (l < 1e-4f || push <= 0) continue;
+			npcs.position[p.a] -= push / l * d;
+			npcs.position[p.b] += push / l * d;
+		}
 	}
+
+	// the turtle: spheres around it, then the sharks' own cylinder vs box test
+	if (turtle.res == nullptr || sharks.empty()) return;
+	cgp::affine const& model = turtle.drawable.model;
+	cgp::vec3 const s = model.scaling * model.scaling_xyz;
+	float const reach = std::max({ s.x, s.y, s.z }) * (norm(turtle.res->half_extents) + norm(turtle.res->center_offset));
+	npc_grid.query(model.translation, reach, npc_near_turtle);
+	cgp::mat4 const M = model.matrix();
+	for (uint32_t h : npc_near_turtle)
+		if (npcs.species[h] == npc_shark && shark_collision(npcs.model_matrix(h), *sharks[0].res, M, *turtle.res))
+			++npc_contacts;
+	if (npc_bite && npc_contacts > 0)
+		game_over = true;
+}
+
+void scene_structure::publish_poses()
+{
+	bones->clear();
+	frame_joint_uniform_calls = 0;
+	auto publish = [this](skinned_actor& actor) {
+		actor.publish_pose(*bones);
+		// glUseProgram x2 + glGetUniformLocation and glUniformMatrix4fv per joint
+		frame_joint_uniform_calls += 2 + 2 * actor.uBones.size();
+	};
+	publish(turtle);
+	for (shark_actor& sh : sharks)
+		publish(sh);
+	school.publish(*bones, environment.camera_view, environment.camera_projection, gui.lod_bias);
+	npcs.publish(*bones, environment.camera_view, environment.camera_projection, gui.lod_bias, timer.t);
+	for (shark_actor const& sh : school.members)
+		frame_joint_uniform_calls += 2 + 2 * sh.uBones.size();
+	bones->upload(skinned_actor::bone_palette_unit);
+}
+
+void scene_structure::apply_skinning()
+{
+	turtle.set_skinning(turtle_skinning, skinning_shaders[int(turtle_skinning)]->shader);
+	for (shark_actor& sh : sharks)
+		sh.set_skinning(shark_skinning, skinning_shaders[int(shark_skinning)]->shader);
+	for (shark_actor& sh : school.members)
+		sh.set_skinning(shark_skinning, skinning_shaders[int(shark_skinning)]->shader);
+}
+
+void scene_structure::draw_actor(skinned_actor& actor)
+{
+	actor.select_lod(environment.camera_view, environment.camera_projection, gui.lod_bias);
+	frame_triangles += actor.draw(environment);
+	frame_skinned_draws += actor.draw_calls();
 }
 
 void scene_structure::display_gui()
 {
+    if (loading) {
+        loading->display_gui();
+        if (!actors_ready)
+            return;
+    }
+
     ImGui::Checkbox("Frame", &gui.display_frame);
     ImGui::Checkbox("Wireframe", &gui.display_wireframe);
+    ImGui::SliderFloat("LOD bias", &gui.lod_bias, 0.25f, 4.0f);
+    ImGui::Text("Triangles / frame: %zu (turtle LOD %d, shark LOD %d)", frame_triangles,
+                turtle.lod, sharks.empty() ? -1 : sharks[0].lod);
+    ImGui::Text("Bone palette: %zu bones, %.1f KiB, %zu GL calls / frame (per-joint uniforms: %zu)",
+                bones->bones(), bones->gpu_bytes() / 1024.0, size_t(bones->gl_calls()) + 2 * frame_skinned_draws,
+                frame_joint_uniform_calls);
+    if (ImGui::SliderInt("School sharks", &school_size, 0, 2000) && !sharks.empty()) {
+        school.center = turtle.drawable.model.translation;
+        school.resize(school_size, sharks[0]);
+    }
+    ImGui::Text("  %d instanced, %zu draw calls", school.size(), school.draw_calls());
+    ImGui::Checkbox("Baked swim cycle", &school.baked);
+    if (school.cycle && school.cycle->ready())
+        ImGui::Text("  %d poses of %.2f s, %.1f KiB, baked in %.2f ms%s", school.cycle->frames,
+                    school.cycle->period, school.cycle->gpu_bytes / 1024.0, school.cycle->bake_ms,
+                    school.baked_active() ? "" : " (live evaluation)");
+    if (ImGui::SliderInt("Roaming sharks", &npc_count, 0, 5000) && npc_shark >= 0)
+        set_npc_count(npc_count);
+    ImGui::Text("  %zu alive in %zu slots, %zu draw calls", npcs.size(), npcs.capacity(), npcs.draw_calls());
+    ImGui::Checkbox("Sharks avoid each other", &npc_avoidance);
+    ImGui::Checkbox("Roaming sharks bite", &npc_bite);
+    ImGui::Text("  broadphase: %zu bodies in %zu cells, %zu pairs / %zu tests (all pairs: %zu), %.3f + %.3f ms, %d turtle contacts",
+                npc_grid.bodies, npc_grid.cells, npc_grid.pairs, npc_grid.tests,
+                npc_grid.bodies * (npc_grid.bodies > 0 ? npc_grid.bodies - 1 : 0) / 2,
+                npc_grid.build_ms, npc_grid.pairs_ms, npc_contacts);
+    int threads = update_threads;
+    if (ImGui::SliderInt("Update threads", &threads, 1, int(std::max(1u, std::thread::hardware_concurrency()))))
+        set_update_threads(threads);
+    ImGui::Text("Update phase: %.3f ms on %d threads", frame_update_ms, update_threads);
+    ImGui::Checkbox("Animation LOD", &anim_lod.enabled);
+    ImGui::SliderInt("Reduced rate: 1 frame in", &anim_lod.interval, 2, 8);
+    ImGui::Text("  full %d, reduced %d, frozen %d sharks: %d animate(), %.3f ms saved",
+                anim_lod.actors[0].load(), anim_lod.actors[1].load(), anim_lod.actors[2].load(),
+                anim_lod.updates.load(), anim_lod.saved_ms());
+    char const* const modes[] = { skinning_name(skinning_mode::matrix), skinning_name(skinning_mode::affine),
+                                  skinning_name(skinning_mode::dual_quaternion) };
+    int turtle_mode = int(turtle_skinning), shark_mode = int(shark_skinning);
+    bool changed = ImGui::Combo("Turtle skinning", &turtle_mode, modes, 3);
+    changed = ImGui::Combo("Shark skinning", &shark_mode, modes, 3) || changed;
+    if (changed) {
+        turtle_skinning = skinning_mode(turtle_mode);
+        shark_skinning  = skinning_mode(shark_mode);
+        apply_skinning();
+    }
+    if (turtle.res != nullptr && !turtle.res->animations.clips.empty()) {
+        std::vector<char const*> clips = { "procedural" };
+        for (gltf_animation_clip const& c : turtle.res->animations.clips)
+            clips.push_back(c.name);
+        int clip = turtle.clip_player.clip + 1;
+        if (ImGui::Combo("Turtle clip", &clip, clips.data(), int(clips.size()))) {
+            if (clip > 0) turtle.play_clip(clip - 1, timer.t);   // by index: names may repeat, or be empty
+            else          turtle.stop_clip();
+        }
+    }
+    if (ImGui::CollapsingHeader("Resources"))
+        resources().display_gui();
+    ImGui::Text("Frame time: %.2f ms", 1000.0f / ImGui::GetIO().Framerate);
+    if (caustics)
+        caustics->display_gui();
 
     ImGui::Separator();
     ImGui::Text("Move Turtle");
@@ -226,6 +527,53 @@ void scene_structure::idle_frame()
     camera_control.idle_frame(environment.camera_view);
 }
 
+void scene_structure::bake_assets(bool compress)
+{
+    std::cout << "Baking asset caches ..." << std::endl;
+    mesh_cache_bake({ project::path + turtle_gltf,
+                      project::path + shark_gltf });
+    texture_pack_bake(project::path + caustic_base,
+                      sequence_frame_names(project::path + caustic_base, caustic_frames),
+                      compress ? texture_pack_format::bc4 : texture_pack_format::r8);
+    std::cout << "Baking finished" << std::endl;
+}
+
+bool scene_structure::run_benchmark(std::string const& name)
+{
+    if (name == "accessors")
+        benchmark_accessors({ project::path + turtle_gltf,
+                              project::path + shark_gltf });
+    else if (name == "textures")
+        benchmark_textures({ project::path + turtle_texture,
+                             project::path + shark_texture });
+    else if (name == "meshopt")
+        benchmark_mesh_optimizer({ project::path + turtle_gltf,
+                                   project::path + shark_gltf });
+    else if (name == "vertex")
+        benchmark_vertex_format({ project::path + turtle_gltf,
+                                  project::path + shark_gltf });
+    else if (name == "caustics")
+        benchmark_caustics(project::path + caustic_base, caustic_frames);
+    else if (name == "clips")
+        benchmark_clips({ project::path + turtle_gltf,
+                          project::path + shark_gltf });
+    else if (name == "animate")
+        benchmark_animate(project::path + turtle_gltf, project::path + shark_gltf);
+    else if (name == "skinning")
+        benchmark_skinning(project::path + shark_gltf);
+    else if (name == "update")
+        benchmark_update(project::path + shark_gltf);
+    else if (name == "npc")
+        benchmark_npc(project::path + shark_gltf);
+    else if (name == "broadphase")
+        benchmark_broadphase();
+    else {
+        std::cerr << "Unknown benchmark \"" << name << "\". Available: accessors, textures, meshopt, vertex, caustics, clips, animate, skinning, update, npc, broadphase" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void scene_structure::display_info()
 {
     std::cout << "\nCAMERA CONTROL:\n"
@@ -4,15 +4,24 @@
 #include "cgp/cgp.hpp"
 #include "environment.hpp"
 #include "loader/gltf_loader.hpp"
+#include "loader/asset_pipeline.hpp"
+#include "loader/flipbook_stream.hpp"
 #include "loader/gpu_skin_helper.hpp" 
 #include "actors/skinned_actor.hpp"
 #include "actors/shark_actor.hpp"
 #include "actors/turtle_actor.hpp"
+#include "actors/shark_school.hpp"
+#include "actors/npc_manager.hpp"
+#include "actors/broadphase.hpp"
+
+#include <memory>
+#include <random>
 
 // Variables associated to the GUI (buttons, etc)
 struct gui_parameters {
     bool display_frame = true;
     bool display_wireframe = false;
+    float lod_bias = 1.0f;         // > 1: detailed LODs kept further away
 };
 
 // The structure of the custom scene
@@ -31,7 +40,22 @@ struct scene_structure : cgp::scene_inputs_generic {
     // helper to spawn one shark
     void spawn_shark();
 
-	shark_actor shark;
+    shark_school school;      // decorative crowd, instanced (copies of sharks[0])
+    int school_size = 0;      // GUI slider
+
+    npc_manager npcs;         // roaming sharks crossing the scene, drawn as sharks[0]
+    int npc_shark = -1;       // its species of sharks[0]
+    int npc_count = 0;        // GUI slider
+    std::mt19937 npc_random{ 2024 };
+    void set_npc_count(int count);
+    void roaming_path(cgp::vec3& origin, cgp::vec3& goal, float& speed);   // a new life across the turtle's area
+    hash_grid_broadphase npc_grid;            // NPC bounding spheres, rebuilt every update phase
+    std::vector<broadphase_pair> npc_pairs;   // overlapping NPCs of the frame
+    std::vector<uint32_t> npc_near_turtle;    // candidates of the NPC-turtle narrowphase
+    bool npc_avoidance = true;                // push overlapping NPCs apart
+    bool npc_bite      = false;               // a roaming shark touching the turtle ends the game
+    int  npc_contacts  = 0;                   // NPC-turtle narrowphase hits of the frame
+    void collide_npcs();                      // broadphase, separation, turtle narrowphase
 
 	// Collision mechanism
 	bool   game_over   = false;
@@ -42,6 +66,13 @@ struct scene_structure : cgp::scene_inputs_generic {
 
     turtle_actor          turtle;
     opengl_shader_structure turtle_shader;
+    std::shared_ptr<shader_resource>        turtle_shader_res;   // owns turtle_shader
+    std::shared_ptr<shader_resource>        skinning_shaders[3]; // turtle.vert.glsl per skinning_mode
+    skinning_mode turtle_skinning = skinning_mode::affine;
+    skinning_mode shark_skinning  = skinning_mode::dual_quaternion;   // no candy wrapper along the spine
+    std::unique_ptr<flipbook_stream>        caustics;            // owns environment.caustic_array_tex
+    static constexpr size_t caustic_budget_bytes = size_t(8) << 20;   // GPU memory of the caustic ring
+    static constexpr int    caustic_decimation   = 4;                 // frames played: 1 in 4, blended
 
     std::vector<cgp::mat4> shark_inverse_bind;
     std::vector<int>       shark_joint_node;    // skin → node
@@ -60,7 +91,30 @@ struct scene_structure : cgp::scene_inputs_generic {
     // Functions
     // ****************************** //
 
+    std::unique_ptr<asset_pipeline> loading;   // non-null while the startup assets load
+    bool actors_ready = false;                 // the game starts before the caustics finish streaming
+    std::vector<std::shared_ptr<void>> preloaded;  // loaded resources, until the actors take them
+
+    size_t frame_triangles = 0;   // actor triangles drawn in the last frame (after LOD selection)
+    void draw_actor(skinned_actor& actor);   // select_lod + draw, counted in frame_triangles
+
+    std::unique_ptr<bone_palette> bones;   // skinning matrices of every actor of the frame
+    size_t frame_skinned_draws = 0;        // GL draws of the skinned meshes in the last frame, one per submesh (2 GL calls each)
+    size_t frame_joint_uniform_calls = 0;  // GL calls the per-joint uniform upload would have made
+    void publish_poses();   // after the animations, before the first actor draw
+
+    std::unique_ptr<thread_pool> workers;   // update phase helpers (null: main thread only)
+    int    update_threads  = 1;             // threads of the update phase, main one included
+    double frame_update_ms = 0;             // update phase of the last frame
+    std::vector<skinned_actor*> update_actors;   // animated in the update phase (reused)
+    animation_lod anim_lod;                 // update rate of the sharks (the turtle: every frame)
+    void set_update_threads(int count);
+    void update_phase(float dt);   // every animate() + pose, in parallel; no GL call
+    void apply_skinning();  // turtle_skinning / shark_skinning to the actors
+
     void initialize();    // called once before the loop
+    void start_loading();      // queue the decode/upload jobs of every asset
+    void initialize_actors();  // once loaded, and on restart
     void display_frame(); // called every frame to draw
     void display_gui();   // ImGui widgets
 
@@ -70,4 +124,7 @@ struct scene_structure : cgp::scene_inputs_generic {
     void idle_frame();    // called every frame before display_frame()
 
     void display_info();
+
+    static void bake_assets(bool compress = false);   // --bake-assets [--bc4]: write binary caches of the scene assets
+    static bool run_benchmark(std::string const& name); // --bench <name>: false if the name is unknown
 };
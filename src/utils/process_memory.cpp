@@ -0,0 +1,21 @@
+#include "process_memory.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+size_t process_peak_rss_bytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return size_t(usage.ru_maxrss);            // bytes on macOS
+#else
+    return size_t(usage.ru_maxrss) * 1024;     // kilobytes on Linux
+#endif
+#else
+    return 0;
+#endif
+}
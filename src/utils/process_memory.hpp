@@ -0,0 +1,11 @@
+#pragma once
+// process_memory.hpp
+// Resident memory of the running process, for load-time reports.
+
+#include <cstddef>
+
+/// Peak resident set size since the process started, in bytes (0 if unknown)
+size_t process_peak_rss_bytes();
+
+/// Bytes → MiB, for printing
+inline double to_mib(size_t bytes) { return double(bytes) / (1024.0 * 1024.0); }
@@ -0,0 +1,81 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+thread_pool::thread_pool(unsigned thread_count)
+{
+    if (thread_count == 0) {
+        unsigned const hw = std::thread::hardware_concurrency();
+        thread_count = std::max(1u, hw > 1 ? hw - 1 : 1u);
+    }
+    threads.reserve(thread_count);
+    for (unsigned k = 0; k < thread_count; ++k)
+        threads.emplace_back(&thread_pool::worker_loop, this);
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads)
+        t.join();
+}
+
+void thread_pool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void thread_pool::parallel_for(size_t count, std::function<void(size_t, size_t)> const& body, size_t grain)
+{
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    // range r is [r * count / ranges, (r + 1) * count / ranges): at least
+    // count / ranges >= grain items each
+    size_t const ranges = std::min(threads.size() + 1, std::max<size_t>(count / grain, 1));
+    if (ranges <= 1) {
+        body(0, count);
+        return;
+    }
+
+    std::mutex              done_mutex;
+    std::condition_variable done;
+    size_t                  remaining = 0;
+    for (size_t r = 1; r < ranges; ++r) {
+        size_t const first = r * count / ranges, last = (r + 1) * count / ranges;
+        {
+            std::lock_guard<std::mutex> lock(done_mutex);
+            ++remaining;
+        }
+        submit([&, first, last] {
+            body(first, last);
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0) done.notify_one();
+        });
+    }
+    body(0, count / ranges);
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+}
+
+void thread_pool::worker_loop()
+{
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;            // stopping, and nothing left to do
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+// thread_pool.hpp
+// Fixed set of worker threads consuming a FIFO of jobs.
+// Jobs must not throw: wrap them (see asset_pipeline) if they can fail.
+// parallel_for splits a loop over the workers and the calling thread; it
+// must not be called from a job of the same pool (the job would wait for
+// workers that may all be waiting too).
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct thread_pool {
+    /// `thread_count` = 0: one worker per hardware thread, minus the caller's (at least 1)
+    explicit thread_pool(unsigned thread_count = 0);
+    /// Runs the jobs still queued, then joins the workers
+    ~thread_pool();
+
+    thread_pool(thread_pool const&)            = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    void   submit(std::function<void()> job);
+    size_t size() const { return threads.size(); }
+
+    /// body(first, last) over [0, count) in at most size() + 1 ranges of at
+    /// least `grain` items (even sizes; one range, inline, below 2 * grain),
+    /// one of them on the calling thread; returns when all are done
+    void parallel_for(size_t count, std::function<void(size_t, size_t)> const& body, size_t grain = 1);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread>          threads;
+    std::deque<std::function<void()>> jobs;
+    std::mutex                        mutex;
+    std::condition_variable           wake;
+    bool                              stopping = false;
+};
@@ -0,0 +1,11 @@
+#pragma once
+// timing.hpp
+// Wall-clock intervals, for load-time reports and benchmarks.
+
+#include <chrono>
+
+/// Milliseconds elapsed since t0
+inline double elapsed_ms(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}